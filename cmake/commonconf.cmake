@@ -22,7 +22,5 @@ endif(WIN32)
 set (CMAKE_LIBRARY_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/lib)
 set (CMAKE_RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/bin)
 
-find_package(Qt5Widgets REQUIRED)
-
 set(CommonconfProcessed TRUE)
 endif(NOT CommonconfProcessed)
@@ -1,6 +1,7 @@
 #include <cts-core/base/log.h>
 #include <cts-core/network/network.h>
 #include <cts-core/simulation/simulation.h>
+#include <cts-core/traffic/trafficmanager.h>
 
 #include <cts-gui/mainwindow.h>
 #include <cts-gui/networkrenderwidget.h>
@@ -26,6 +27,7 @@ int main(int argc, char** argv)
 	//network.importLegacyXml("network.xml");
 
 	cts::core::Simulation simulation(network);
+	simulation.getTrafficManager().setNumThreads(0);
 	simulation.start(1000);
 
 	sol::state lua;
@@ -0,0 +1,371 @@
+#include <cts-core/base/log.h>
+#include <cts-core/network/contractionhierarchy.h>
+#include <cts-core/network/landmarks.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/routing.h>
+#include <cts-core/simulation/replicationrunner.h>
+#include <cts-core/simulation/simulation.h>
+#include <cts-core/traffic/trafficmanager.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehicle.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Options
+	{
+		std::string networkFile;
+		uint32_t seed = 42;
+		double duration = 3600.0;
+		double trafficMultiplier = 1.0;
+		double ticksPerSecond = 15.0;
+		double routeTreeInterval = 0.0;
+		double costSnapshotInterval = 0.0;
+		bool asyncRouting = false;
+		size_t numThreads = 0;
+		size_t numReplications = 1;
+		size_t numRoutingQueries = 0;
+	};
+
+
+	void printUsage(const char* executable)
+	{
+		std::cerr << "Usage: " << executable << " <network.xml> [options]\n"
+			<< "Runs a CityTrafficSimulator++ scenario as fast as possible without any GUI.\n\n"
+			<< "Options:\n"
+			<< "  --seed <n>               Random seed (default: 42)\n"
+			<< "  --duration <s>           Simulated duration in seconds (default: 3600)\n"
+			<< "  --multiplier <x>         Global traffic multiplier (default: 1.0)\n"
+			<< "  --ticks-per-second <n>   Simulation steps per simulated second (default: 15)\n"
+			<< "  --route-trees <s>        Let vehicles follow shortest-path trees shared per destination,\n"
+			<< "                           recomputed every <s> simulated seconds, 0 to disable (default: 0)\n"
+			<< "  --cost-snapshot <s>      Let the route search use a snapshot of the connection costs,\n"
+			<< "                           refreshed every <s> simulated seconds, 0 to use the live\n"
+			<< "                           traffic (default: 0). Route queries are only cached with a\n"
+			<< "                           snapshot\n"
+			<< "  --async-routing          Plan new routes on the worker threads, vehicles keep their route\n"
+			<< "                           until the new one is delivered at the next tick\n"
+			<< "  --threads <n>            Number of threads, 0 for hardware concurrency (default: 0)\n"
+			<< "  --replications <n>       Number of replications with consecutive seeds starting at --seed,\n"
+			<< "                           run concurrently on --threads threads (default: 1)\n"
+			<< "  --routing-benchmark <n>  Compare <n> random route queries of the A* search with and without\n"
+			<< "                           landmarks and the contraction hierarchy instead of running a\n"
+			<< "                           simulation (default: 0)\n";
+	}
+
+
+	bool parseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			const bool hasValue = (i + 1 < argc);
+
+			if (arg == "--help" || arg == "-h")
+				return false;
+			else if (arg == "--seed" && hasValue)
+				options.seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+			else if (arg == "--duration" && hasValue)
+				options.duration = std::atof(argv[++i]);
+			else if (arg == "--multiplier" && hasValue)
+				options.trafficMultiplier = std::atof(argv[++i]);
+			else if (arg == "--ticks-per-second" && hasValue)
+				options.ticksPerSecond = std::atof(argv[++i]);
+			else if (arg == "--route-trees" && hasValue)
+				options.routeTreeInterval = std::atof(argv[++i]);
+			else if (arg == "--cost-snapshot" && hasValue)
+				options.costSnapshotInterval = std::atof(argv[++i]);
+			else if (arg == "--async-routing")
+				options.asyncRouting = true;
+			else if (arg == "--threads" && hasValue)
+				options.numThreads = size_t(std::strtoul(argv[++i], nullptr, 10));
+			else if (arg == "--replications" && hasValue)
+				options.numReplications = size_t(std::strtoul(argv[++i], nullptr, 10));
+			else if (arg == "--routing-benchmark" && hasValue)
+				options.numRoutingQueries = size_t(std::strtoul(argv[++i], nullptr, 10));
+			else if (arg.compare(0, 2, "--") != 0 && options.networkFile.empty())
+				options.networkFile = arg;
+			else
+			{
+				std::cerr << "Invalid argument: " << arg << "\n";
+				return false;
+			}
+		}
+
+		return !options.networkFile.empty() && options.duration > 0.0 && options.ticksPerSecond > 0.0 && options.numReplications > 0;
+	}
+
+
+	/// Mean and sample standard deviation of a set of values.
+	struct Summary
+	{
+		double mean;
+		double standardDeviation;
+	};
+
+
+	template<typename Func>
+	Summary summarize(const std::vector<cts::core::ReplicationRunner::Result>& results, Func&& func)
+	{
+		double sum = 0.0;
+		for (auto& r : results)
+			sum += func(r);
+		const double mean = sum / results.size();
+
+		double squaredSum = 0.0;
+		for (auto& r : results)
+			squaredSum += (func(r) - mean) * (func(r) - mean);
+		return Summary{ mean, results.size() > 1 ? std::sqrt(squaredSum / (results.size() - 1)) : 0.0 };
+	}
+
+
+	std::ostream& operator<<(std::ostream& os, const Summary& summary)
+	{
+		return os << summary.mean << " +/- " << summary.standardDeviation;
+	}
+
+
+	double getSeconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double>(end - begin).count();
+	}
+
+
+	int runRoutingBenchmark(const Options& options, const cts::core::Network& network)
+	{
+		using namespace cts::core;
+		const auto& nodes = network.getNodes();
+		const double targetVelocity = 42.0;
+
+		TrafficState trafficState(network);
+		TypedVehicle<IdmMobil> vehicle(trafficState, *nodes.front(), {}, targetVelocity);
+
+		const auto timeBefore = std::chrono::steady_clock::now();
+		ContractionHierarchy hierarchy(network);
+		const auto timeBuilt = std::chrono::steady_clock::now();
+		hierarchy.customize(trafficState, targetVelocity);
+		const auto timeCustomized = std::chrono::steady_clock::now();
+
+		// same random queries for both searches
+		std::mt19937 rng(options.seed);
+		std::uniform_int_distribution<size_t> nodeDistribution(0, nodes.size() - 1);
+		std::vector< std::pair<const Node*, std::vector<Node*>> > queries;
+		for (size_t i = 0; i < options.numRoutingQueries; ++i)
+			queries.emplace_back(nodes[nodeDistribution(rng)].get(), std::vector<Node*>{ nodes[nodeDistribution(rng)].get() });
+
+		auto computeCosts = [](const Routing& routing) {
+			double costs = 0.0;
+			for (auto& segment : routing.getSegments())
+				costs += segment.costs;
+			return costs;
+		};
+
+		Routing routing;
+		auto runSearch = [&](std::vector<double>& costs, size_t& numExpandedNodes) {
+			costs.clear();
+			numExpandedNodes = 0;
+			const auto searchBefore = std::chrono::steady_clock::now();
+			for (auto& q : queries)
+			{
+				routing.compute(*q.first, q.second, vehicle);
+				costs.push_back(computeCosts(routing));
+				numExpandedNodes += routing.getNumExpandedNodes();
+			}
+			return getSeconds(searchBefore, std::chrono::steady_clock::now());
+		};
+
+		// A* search with the air-line distance as heuristic
+		Landmarks& landmarks = trafficState.getLandmarks();
+		const size_t numLandmarks = landmarks.getNumLandmarks();
+		landmarks.setNumLandmarks(0);
+		landmarks.update();
+		std::vector<double> searchCosts;
+		size_t searchExpandedNodes;
+		const double searchTime = runSearch(searchCosts, searchExpandedNodes);
+
+		// A* search with landmarks as heuristic
+		const auto landmarksBefore = std::chrono::steady_clock::now();
+		landmarks.setNumLandmarks(numLandmarks);
+		landmarks.update();
+		const auto landmarksAfter = std::chrono::steady_clock::now();
+		std::vector<double> landmarkCosts;
+		size_t landmarkExpandedNodes;
+		const double landmarkTime = runSearch(landmarkCosts, landmarkExpandedNodes);
+
+		size_t numFound = 0;
+		size_t numCheaper = 0;
+		const auto hierarchyBefore = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < queries.size(); ++i)
+		{
+			routing.compute(hierarchy, *queries[i].first, queries[i].second, vehicle);
+			if (!routing.getSegments().empty())
+				++numFound;
+			// the Euclidean heuristic of the A* search may overestimate the costs of fast connections
+			if (computeCosts(routing) < searchCosts[i] * (1.0 - 1e-9))
+				++numCheaper;
+		}
+		const auto hierarchyAfter = std::chrono::steady_clock::now();
+
+		const double hierarchyTime = getSeconds(hierarchyBefore, hierarchyAfter);
+		std::cout << std::fixed << std::setprecision(2)
+			<< "Network:              " << options.networkFile << "\n"
+			<< "Nodes:                " << nodes.size() << "\n"
+			<< "Connections:          " << network.getNumConnections() << "\n"
+			<< "Hierarchy arcs:       " << hierarchy.getNumArcs() << "\n"
+			<< "Build time:           " << getSeconds(timeBefore, timeBuilt) * 1e3 << " ms\n"
+			<< "Customization time:   " << getSeconds(timeBuilt, timeCustomized) * 1e3 << " ms\n"
+			<< "Queries:              " << queries.size() << " (" << numFound << " routes found)\n"
+			<< "A* query time:        " << (queries.empty() ? 0.0 : searchTime / queries.size() * 1e6) << " us\n"
+			<< "A* expanded nodes:    " << (queries.empty() ? 0.0 : double(searchExpandedNodes) / queries.size()) << "\n"
+			<< "Landmarks:            " << landmarks.getLandmarkNodes().size() << " (" << getSeconds(landmarksBefore, landmarksAfter) * 1e3 << " ms)\n"
+			<< "ALT query time:       " << (queries.empty() ? 0.0 : landmarkTime / queries.size() * 1e6) << " us\n"
+			<< "ALT expanded nodes:   " << (queries.empty() ? 0.0 : double(landmarkExpandedNodes) / queries.size()) << "\n"
+			<< "Hierarchy query time: " << (queries.empty() ? 0.0 : hierarchyTime / queries.size() * 1e6) << " us\n"
+			<< "Speedup:              " << (hierarchyTime > 0.0 ? searchTime / hierarchyTime : 0.0) << "\n"
+			<< "Cheaper routes:       " << numCheaper << "\n";
+		return 0;
+	}
+
+
+	int runReplications(const Options& options, const cts::core::Network& network)
+	{
+		std::vector<uint32_t> seeds;
+		for (size_t i = 0; i < options.numReplications; ++i)
+			seeds.push_back(options.seed + uint32_t(i));
+
+		cts::core::ReplicationRunner runner(network);
+		runner.setDuration(options.duration);
+		runner.setTicksPerSecond(options.ticksPerSecond);
+		runner.setTrafficMultiplier(options.trafficMultiplier);
+		runner.setRouteTreeInterval(options.routeTreeInterval);
+		runner.setCostSnapshotInterval(options.costSnapshotInterval);
+		runner.setAsyncRouting(options.asyncRouting);
+		runner.setNumThreads(options.numThreads);
+		const auto report = runner.run(seeds);
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< "Network:              " << options.networkFile << "\n"
+			<< "Replications:         " << options.numReplications << "\n"
+			<< "Traffic multiplier:   " << options.trafficMultiplier << "\n"
+			<< "Wall-clock time:      " << report.wallTime << " s\n\n"
+			<< "      Seed   Spawned   Arrived   Remaining   Avg. time [s]   Avg. velocity [m/s]   Wall time [s]\n";
+
+		for (auto& r : report.results)
+		{
+			const auto& stats = r.statistics;
+			std::cout
+				<< std::setw(10) << r.seed
+				<< std::setw(10) << stats.numSpawnedVehicles
+				<< std::setw(10) << stats.numArrivedVehicles
+				<< std::setw(12) << r.numRemainingVehicles
+				<< std::setw(16) << (stats.numArrivedVehicles > 0 ? stats.totalTravelTime / stats.numArrivedVehicles : 0.0)
+				<< std::setw(22) << (stats.totalTravelTime > 0.0 ? stats.totalTravelDistance / 10.0 / stats.totalTravelTime : 0.0)
+				<< std::setw(16) << r.wallTime << "\n";
+		}
+
+		// distances are stored in dm
+		using Result = cts::core::ReplicationRunner::Result;
+		std::cout << "\n"
+			<< "Spawned vehicles:     " << summarize(report.results, [](const Result& r) { return double(r.statistics.numSpawnedVehicles); }) << "\n"
+			<< "Arrived vehicles:     " << summarize(report.results, [](const Result& r) { return double(r.statistics.numArrivedVehicles); }) << "\n"
+			<< "Remaining vehicles:   " << summarize(report.results, [](const Result& r) { return double(r.numRemainingVehicles); }) << "\n"
+			<< "Average travel time:  " << summarize(report.results, [](const Result& r) { 
+				return r.statistics.numArrivedVehicles > 0 ? r.statistics.totalTravelTime / r.statistics.numArrivedVehicles : 0.0; 
+			}) << " s\n"
+			<< "Average velocity:     " << summarize(report.results, [](const Result& r) { 
+				return r.statistics.totalTravelTime > 0.0 ? r.statistics.totalTravelDistance / 10.0 / r.statistics.totalTravelTime : 0.0; 
+			}) << " m/s\n";
+
+		return 0;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	auto cs = std::make_unique<cts::core::ConsoleLogger>(false, false);
+	cs->addFilter(cts::core::Logger::Level::Info, "");
+	cts::core::LogManager::get().addLogger(std::move(cs));
+
+	cts::core::Network network;
+	network.importLegacyXml(options.networkFile, options.numThreads);
+	if (network.getConnections().empty())
+	{
+		std::cerr << "Could not load any connections from " << options.networkFile << "\n";
+		return 1;
+	}
+
+	if (options.numRoutingQueries > 0)
+		return runRoutingBenchmark(options, network);
+	if (options.numReplications > 1)
+		return runReplications(options, network);
+
+	cts::core::Simulation simulation(network);
+	simulation.setTicksPerSecond(options.ticksPerSecond);
+	simulation.reset(options.seed);
+
+	cts::core::TrafficManager& trafficManager = simulation.getTrafficManager();
+	trafficManager.setGlobalTrafficMultiplier(options.trafficMultiplier);
+	trafficManager.setRouteTreeInterval(options.routeTreeInterval);
+	trafficManager.setCostSnapshotInterval(options.costSnapshotInterval);
+	trafficManager.setAsyncRouting(options.asyncRouting);
+	trafficManager.setNumThreads(options.numThreads);
+
+	// Run the simulation synchronously as fast as possible, Simulation::start() would pace it to wall-clock time.
+	size_t numTicks = 0;
+	const auto timeBefore = std::chrono::steady_clock::now();
+	while (simulation.getCurrentTime() < options.duration)
+	{
+		simulation.step();
+		++numTicks;
+	}
+	const auto timeAfter = std::chrono::steady_clock::now();
+	const double wallTime = std::chrono::duration<double>(timeAfter - timeBefore).count();
+
+	const auto& stats = trafficManager.getStatistics();
+	std::cout << std::fixed << std::setprecision(2)
+		<< "Network:              " << options.networkFile << "\n"
+		<< "Seed:                 " << options.seed << "\n"
+		<< "Traffic multiplier:   " << options.trafficMultiplier << "\n"
+		<< "Threads:              " << trafficManager.getNumThreads() << "\n"
+		<< "Simulated time:       " << simulation.getCurrentTime() << " s\n"
+		<< "Ticks:                " << numTicks << "\n"
+		<< "Wall-clock time:      " << wallTime << " s\n"
+		<< "Ticks per second:     " << (wallTime > 0.0 ? numTicks / wallTime : 0.0) << "\n"
+		<< "Real-time factor:     " << (wallTime > 0.0 ? simulation.getCurrentTime() / wallTime : 0.0) << "\n"
+		<< "Spawned vehicles:     " << stats.numSpawnedVehicles << "\n"
+		<< "Arrived vehicles:     " << stats.numArrivedVehicles << "\n"
+		<< "Remaining vehicles:   " << trafficManager.getVehicles().size() << "\n"
+		<< "Lookahead overflows:  " << stats.numRegistrationOverflows << "\n"
+		<< "Route computations:   " << stats.numRouteComputations << "\n"
+		<< "Route cache hits:     " << simulation.getTrafficState().getRouteStore().getNumQueryHits() << "\n"
+		<< "Shared routes:        " << simulation.getTrafficState().getRouteStore().getNumRoutes() << "\n"
+		<< "Route repairs:        " << stats.numRouteRepairs << "\n";
+
+	if (stats.numArrivedVehicles > 0)
+	{
+		// distances are stored in dm
+		std::cout
+			<< "Average travel time:  " << stats.totalTravelTime / stats.numArrivedVehicles << " s\n"
+			<< "Average distance:     " << stats.totalTravelDistance / 10.0 / stats.numArrivedVehicles << " m\n"
+			<< "Average velocity:     " << (stats.totalTravelTime > 0.0 ? stats.totalTravelDistance / 10.0 / stats.totalTravelTime : 0.0) << " m/s\n";
+	}
+
+	return 0;
+}
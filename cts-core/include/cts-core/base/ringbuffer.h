@@ -0,0 +1,196 @@
+#ifndef CTS_CORE_RINGBUFFER_H__
+#define CTS_CORE_RINGBUFFER_H__
+
+#include <cts-core/base/utils.h>
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cts { namespace core
+{
+	/**
+	 * Double-ended queue of elements in a single contiguous ring of slots.
+	 *
+	 * Elements are appended at the back and removed from either end. Removed slots are reused by
+	 * later elements, so as long as the number of elements stays within the capacity, the buffer
+	 * never allocates. If it does not, the buffer doubles its capacity, which is counted by
+	 * getNumOverflows().
+	 *
+	 * Unlike std::vector, iterators to the remaining elements stay valid when removing elements from
+	 * either end or when the buffer grows.
+	 *
+	 * \tparam	T	Type of the elements, must be move-constructible.
+	 */
+	template<typename T>
+	class RingBuffer : public utils::NotCopyable
+	{
+	private:
+		template<bool IsConst>
+		class Iterator
+		{
+		public:
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+			using reference = typename std::conditional<IsConst, const T&, T&>::type;
+			using BufferType = typename std::conditional<IsConst, const RingBuffer, RingBuffer>::type;
+
+			Iterator() : m_buffer(nullptr), m_position(0) {}
+			Iterator(BufferType* buffer, size_t position) : m_buffer(buffer), m_position(position) {}
+			/// Implicit conversion from non-const to const iterators.
+			/// A template, so that it does not suppress the implicit copy operations of non-const iterators.
+			template<bool OtherIsConst, typename = typename std::enable_if<IsConst && !OtherIsConst>::type>
+			Iterator(const Iterator<OtherIsConst>& other) : m_buffer(other.m_buffer), m_position(other.m_position) {}
+
+			reference operator*() const { return m_buffer->at(m_position); }
+			pointer operator->() const { return &m_buffer->at(m_position); }
+
+			Iterator& operator++() { ++m_position; return *this; }
+			Iterator operator++(int) { Iterator toReturn(*this); ++m_position; return toReturn; }
+			Iterator& operator--() { --m_position; return *this; }
+			Iterator operator--(int) { Iterator toReturn(*this); --m_position; return toReturn; }
+
+			bool operator==(const Iterator& rhs) const { return m_position == rhs.m_position; }
+			bool operator!=(const Iterator& rhs) const { return m_position != rhs.m_position; }
+
+		private:
+			friend class RingBuffer;
+			friend class Iterator<true>;
+
+			BufferType* m_buffer;	///< Buffer this iterator belongs to.
+			size_t m_position;		///< Absolute position of the element, see m_begin.
+		};
+
+	public:
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+
+		/// Creates a new empty RingBuffer.
+		/// \param	capacity	Number of elements the buffer can hold without allocating, rounded up to a power of two.
+		explicit RingBuffer(size_t capacity)
+			: m_capacity(1)
+			, m_begin(0)
+			, m_end(0)
+			, m_numOverflows(0)
+		{
+			while (m_capacity < capacity)
+				m_capacity *= 2;
+			m_slots.reset(new Slot[m_capacity]);
+		}
+
+		~RingBuffer()
+		{
+			clear();
+		}
+
+
+		/// Returns the number of elements.
+		size_t size() const { return m_end - m_begin; }
+		/// Returns whether the buffer holds no elements.
+		bool empty() const { return m_begin == m_end; }
+		/// Returns the number of elements the buffer can hold without allocating.
+		size_t capacity() const { return m_capacity; }
+		/// Returns how often the buffer had to grow since it was created.
+		size_t getNumOverflows() const { return m_numOverflows; }
+
+		iterator begin() { return iterator(this, m_begin); }
+		iterator end() { return iterator(this, m_end); }
+		const_iterator begin() const { return const_iterator(this, m_begin); }
+		const_iterator end() const { return const_iterator(this, m_end); }
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+		const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+		T& front() { assert(!empty()); return at(m_begin); }
+		const T& front() const { assert(!empty()); return at(m_begin); }
+		T& back() { assert(!empty()); return at(m_end - 1); }
+		const T& back() const { assert(!empty()); return at(m_end - 1); }
+
+
+		/// Constructs a new element at the end of the buffer, grows the buffer if it is full.
+		template<typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			if (size() == m_capacity)
+				grow();
+
+			T* element = new (m_slots[m_end & (m_capacity - 1)].data) T(std::forward<Args>(args)...);
+			++m_end;
+			return *element;
+		}
+
+		/// Removes the elements in [first, last), which must either start at begin() or end at end().
+		/// \return	Iterator to the element following the removed ones.
+		iterator erase(iterator first, iterator last)
+		{
+			assert(first.m_position <= last.m_position);
+			assert(first.m_position == m_begin || last.m_position == m_end);
+
+			for (size_t p = first.m_position; p != last.m_position; ++p)
+				at(p).~T();
+
+			if (first.m_position == m_begin)
+			{
+				m_begin = last.m_position;
+				return begin();
+			}
+			else
+			{
+				m_end = first.m_position;
+				return end();
+			}
+		}
+
+		/// Removes all elements.
+		void clear()
+		{
+			erase(begin(), end());
+		}
+
+	private:
+		/// Uninitialized storage for a single element.
+		struct Slot
+		{
+			alignas(T) unsigned char data[sizeof(T)];
+		};
+
+		T& at(size_t position) { return *reinterpret_cast<T*>(m_slots[position & (m_capacity - 1)].data); }
+		const T& at(size_t position) const { return *reinterpret_cast<const T*>(m_slots[position & (m_capacity - 1)].data); }
+
+		/// Doubles the capacity while keeping the absolute positions of all elements.
+		void grow()
+		{
+			const size_t newCapacity = 2 * m_capacity;
+			std::unique_ptr<Slot[]> newSlots(new Slot[newCapacity]);
+			for (size_t p = m_begin; p != m_end; ++p)
+			{
+				new (newSlots[p & (newCapacity - 1)].data) T(std::move(at(p)));
+				at(p).~T();
+			}
+
+			m_slots = std::move(newSlots);
+			m_capacity = newCapacity;
+			++m_numOverflows;
+		}
+
+		std::unique_ptr<Slot[]> m_slots;	///< Storage for the elements.
+		size_t m_capacity;					///< Number of slots, always a power of two.
+		size_t m_begin;						///< Absolute position of the first element, which is stored in slot m_begin % m_capacity.
+		size_t m_end;						///< Absolute position following the last element.
+		size_t m_numOverflows;				///< Number of times the buffer had to grow.
+	};
+
+}
+}
+
+#endif
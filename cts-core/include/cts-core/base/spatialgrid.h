@@ -0,0 +1,55 @@
+#ifndef CTS_CORE_SPATIALGRID_H__
+#define CTS_CORE_SPATIALGRID_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/bounds.h>
+#include <cts-core/base/utils.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cts { namespace core
+{
+	/**
+	 * Uniform grid over a fixed set of 2D bounding boxes for finding all boxes overlapping a query box.
+	 *
+	 * Each box is registered with all grid cells it overlaps, a query only tests the boxes registered
+	 * with the cells overlapping the query box instead of all boxes. The cell size is chosen from the
+	 * average extent of the boxes, so that a box typically overlaps only a few cells.
+	 *
+	 * The grid is immutable once built, hence it may be queried concurrently.
+	 */
+	class CTS_CORE_API SpatialGrid : public utils::NotCopyable
+	{
+	public:
+		/// Builds the grid over the given bounding boxes, empty boxes are ignored.
+		/// \param	bounds	Bounding boxes to index, identified by their index in this list.
+		explicit SpatialGrid(std::vector<Bounds2> bounds);
+
+		/// Returns the number of grid cells along the x and y axis.
+		std::pair<size_t, size_t> getNumCells() const;
+
+		/// Collects the indices of all boxes intersecting \e bounds in ascending order.
+		/// \param	bounds	Query bounding box.
+		/// \param	output	Receives the indices of the intersecting boxes, cleared beforehand.
+		void query(const Bounds2& bounds, std::vector<size_t>& output) const;
+
+	private:
+		/// Returns the range of cell coordinates overlapped by \e bounds along the given axis, clamped to the grid.
+		std::pair<size_t, size_t> getCellRange(const Bounds2& bounds, int axis) const;
+
+		std::vector<Bounds2> m_bounds;			///< Indexed bounding boxes.
+		Bounds2 m_gridBounds;					///< Bounds of all non-empty boxes.
+		double m_cellSize;						///< Edge length of each grid cell.
+		size_t m_numCellsX;						///< Number of grid cells along the x axis.
+		size_t m_numCellsY;						///< Number of grid cells along the y axis.
+		std::vector<uint32_t> m_cellStarts;		///< Offset of the first box of each cell in m_cellItems, plus the total number of entries.
+		std::vector<uint32_t> m_cellItems;		///< Indices of the boxes registered with each cell, grouped by cell in ascending order.
+	};
+
+}
+}
+
+#endif
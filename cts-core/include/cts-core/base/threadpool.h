@@ -0,0 +1,58 @@
+#ifndef CTS_CORE_THREADPOOL_H__
+#define CTS_CORE_THREADPOOL_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cts { namespace core
+{
+	/**
+	 * Simple pool of worker threads executing tasks from a shared FIFO queue.
+	 *
+	 * Besides fire-and-forget tasks, ThreadPool provides parallelFor() to split a range of indices
+	 * into chunks that are processed concurrently by the workers and the calling thread.
+	 */
+	class CTS_CORE_API ThreadPool : public utils::NotCopyable
+	{
+	public:
+		/// Creates a new ThreadPool.
+		/// \param	numThreads	Total number of threads to use including the calling thread, 0 to use the hardware concurrency.
+		explicit ThreadPool(size_t numThreads = 0);
+
+		/// Waits for all pending tasks to finish and joins the worker threads.
+		~ThreadPool();
+
+		/// Returns the total number of threads used by parallelFor() including the calling thread.
+		size_t getNumThreads() const;
+
+		/// Enqueues the given task for asynchronous execution on one of the worker threads.
+		/// If the pool has no worker threads, the task is executed immediately on the calling thread.
+		void enqueue(std::function<void()> task);
+
+		/// Calls \e func for consecutive chunks [begin, end) covering the index range [0, count) and
+		/// blocks until all chunks have been processed.
+		/// \param	count		Number of indices to process.
+		/// \param	func		Function to call for each chunk, must be safe to call concurrently.
+		void parallelFor(size_t count, const std::function<void(size_t, size_t)>& func);
+
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> m_workers;			///< Worker threads, does not include the calling thread.
+		std::deque< std::function<void()> > m_tasks;	///< Queue of pending tasks.
+		std::mutex m_mutex;							///< Mutex protecting m_tasks and m_stop.
+		std::condition_variable m_condition;		///< Condition variable signalling new tasks or m_stop.
+		bool m_stop;								///< Flag whether the workers should terminate.
+	};
+
+}
+}
+
+#endif
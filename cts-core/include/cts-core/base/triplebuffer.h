@@ -0,0 +1,87 @@
+#ifndef CTS_CORE_TRIPLEBUFFER_H__
+#define CTS_CORE_TRIPLEBUFFER_H__
+
+#include <cts-core/base/utils.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace cts { namespace core
+{
+	/**
+	 * Lock-free triple buffer to hand over values from a single producer thread to a single
+	 * consumer thread.
+	 *
+	 * The producer fills the write buffer and publishes it, the consumer fetches the latest
+	 * published value. Neither side ever blocks the other one: The producer can always continue
+	 * writing and the consumer always gets the latest complete value. Intermediate values that
+	 * were never fetched are silently dropped.
+	 *
+	 * Since buffers are reused in a round-robin fashion, T should retain its memory when being
+	 * overwritten (e.g. use clear() on vectors) so that the hand over does not allocate.
+	 *
+	 * \tparam	T	Type of the buffered value, must be default-constructible.
+	 */
+	template<typename T>
+	class TripleBuffer : public utils::NotCopyable
+	{
+	public:
+		/// Creates a new TripleBuffer with three default-constructed values.
+		TripleBuffer()
+			: m_writeIndex(0)
+			, m_readIndex(1)
+			, m_middleIndex(2)
+		{}
+
+		/// Returns the buffer that the producer may write to.
+		/// \note	Must only be called by the producer.
+		T& getWriteBuffer()
+		{
+			return m_buffers[m_writeIndex];
+		}
+
+		/// Publishes the current write buffer so that the consumer can fetch it.
+		/// Afterwards, getWriteBuffer() returns a different buffer, possibly holding an older value.
+		/// \note	Must only be called by the producer.
+		void publish()
+		{
+			m_writeIndex = m_middleIndex.exchange(uint8_t(m_writeIndex | DirtyFlag), std::memory_order_acq_rel) & IndexMask;
+		}
+
+		/// Fetches the latest published value if there is one that has not been fetched yet.
+		/// \return	True if a new value was fetched, false if getReadBuffer() still holds the latest value.
+		/// \note	Must only be called by the consumer.
+		bool fetch()
+		{
+			if ((m_middleIndex.load(std::memory_order_relaxed) & DirtyFlag) == 0)
+				return false;
+
+			m_readIndex = m_middleIndex.exchange(m_readIndex, std::memory_order_acq_rel) & IndexMask;
+			return true;
+		}
+
+		/// Returns the buffer holding the value fetched by the last call to fetch().
+		/// \note	Must only be called by the consumer.
+		const T& getReadBuffer() const
+		{
+			return m_buffers[m_readIndex];
+		}
+
+	private:
+		enum : uint8_t
+		{
+			IndexMask = 0x03,	///< Bit mask to extract the buffer index from m_middleIndex.
+			DirtyFlag = 0x04	///< Flag set in m_middleIndex when it holds a value not yet fetched.
+		};
+
+		std::array<T, 3> m_buffers;				///< The three buffers.
+		uint8_t m_writeIndex;					///< Index of the buffer owned by the producer.
+		uint8_t m_readIndex;					///< Index of the buffer owned by the consumer.
+		std::atomic<uint8_t> m_middleIndex;		///< Index of the buffer being handed over, combined with DirtyFlag.
+	};
+
+}
+}
+
+#endif
@@ -70,6 +70,12 @@ namespace cts { namespace core
 		/// \param  time	Location on this curve in terms of time.
 		vec2 derivateAtTime(double time) const;
 
+		/// Splits the curve given by \e supportPoints at time 0.5 into two curves following the same path.
+		/// \param	supportPoints	Support points of the curve to split.
+		/// \param	first			Receives the support points of the first half.
+		/// \param	second			Receives the support points of the second half.
+		static void subdivide(const std::array<vec2, 4>& supportPoints, std::array<vec2, 4>& first, std::array<vec2, 4>& second);
+
 	private:
 		/// Computes the LUT to convert between time and arc position.
 		void computeLengthApproximationTable();
@@ -6,12 +6,10 @@
 #include <cts-core/network/bezierparameterization.h>
 #include <cts-core/network/intersection.h>
 
-#include <list>
 #include <vector>
 
 namespace cts { namespace core
 {
-	class AbstractVehicle;
 	class Network;
 	class Node;
 
@@ -24,9 +22,6 @@ namespace cts { namespace core
 		friend class Network;
 
 	public:
-		// TODO: consider making vehicles const
-		using VehicleListType = std::list<AbstractVehicle*>;
-
 		/// Creates a new network connection with the given parameters.
 		/// The Bzier support points are taken from the start and end nodes.
 		/// \param	startNode		Start network node of this connection.
@@ -39,8 +34,9 @@ namespace cts { namespace core
 		const Node& getEndNode() const;
 		/// Returns the Bzier curve parameterization of this connection.
 		const BezierParameterization& getCurve() const;
-		/// Returns the list of vehicles currently on this connection, sorted by their position.
-		const VehicleListType& getVehicles() const;
+		/// Returns the index of this connection within its Network.
+		/// Traffic states use this index to store per-connection data.
+		size_t getIndex() const;
 
 		/// Returns the priority of this network connection.
 		int getPriority() const;
@@ -50,43 +46,29 @@ namespace cts { namespace core
 		/// Returns the target velocity of this Connection in m/s.
 		double getTargetVelocity() const;
 		/// Sets the target velocity of this Connection in m/s.
+		/// Increments the cost revision of the owning Network if the value changes.
 		void setTargetVelocity(double value);
 
 
 		/// Recalculates the Bzier parameterization curve based on the node's properties.
+		/// Increments the cost revision of the owning Network.
 		void updateCurve();
 
 
-		void addVehicle(AbstractVehicle* vehicle, double arcPosition);
-		void removeVehicle(AbstractVehicle* vehicle);
-
-		/// Returns the first vehicle to be found behind \e arcPosition within \e searchDistance.
-		/// If \e searchDistance exceeds the length of this Connection, the function will recursively check
-		/// all following connections.
-		VehicleDistance getVehicleBehind(double arcPosition, double searchDistance) const;
-
-		/// Returns the first vehicle to be found before \e arcPosition within \e searchDistance.
-		/// If \e searchDistance exceeds the length of this Connection, the function will recursively check
-		/// all previous connections.
-		VehicleDistance getVehicleBefore(double arcPosition, double searchDistance) const;
-
-
 		const std::vector<Intersection*>& getIntersections() const;
 
 	private:
-		VehicleListType::const_iterator vehicleIteratorBehind(double arcPosition) const;
-		VehicleListType::const_iterator vehicleIteratorBefore(double arcPosition) const;
-
 		void addIntersection(Intersection* intersection);
 
 		const Node& m_startNode;                    ///< Start network node of this connection.
 		const Node& m_endNode;                      ///< End network node of this connection.
 		BezierParameterization m_curve;				///< Bzier curve parameterization of this connection.
 
+		Network* m_network;							///< Network owning this connection, nullptr if it is not part of one.
+		size_t m_index;								///< Index of this connection within its Network.
 		int m_priority;								///< Priority of this network connection.
 		double m_targetVelocity;					///< Target velocity of this network connection in m/s.
 
-		VehicleListType m_vehicles;					///< List of vehicles currently on this connection, sorted by their position.
 		std::vector<Intersection*> m_intersections;	///< List of intersections with other Connections, sorted by their position.
 	};
 
@@ -0,0 +1,86 @@
+#ifndef CTS_CORE_CONTRACTIONHIERARCHY_H__
+#define CTS_CORE_CONTRACTIONHIERARCHY_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Connection;
+	class Network;
+	class Node;
+	class TrafficState;
+
+	/**
+	 * Customizable contraction hierarchy for fast shortest-path queries on large networks.
+	 *
+	 * Building the hierarchy only depends on the topology of the network: all nodes are ordered by a
+	 * nested dissection along their positions and contracted one after another, connecting all remaining
+	 * neighbors of a contracted node by shortcuts. The costs of the connections are applied afterwards by
+	 * customize(), which computes the costs of all shortcuts in a single pass. Hence, changing costs, e.g.
+	 * due to congestion, only require to customize the hierarchy again instead of rebuilding it.
+	 *
+	 * Queries run a bidirectional Dijkstra search that only follows arcs toward more important nodes and
+	 * therefore settle only a small fraction of the network.
+	 */
+	class CTS_CORE_API ContractionHierarchy : public utils::NotCopyable
+	{
+	public:
+		/// Builds the hierarchy for the current topology of \e network.
+		/// The hierarchy needs to be rebuilt when nodes or connections are added or removed.
+		explicit ContractionHierarchy(const Network& network);
+
+		/// Returns the network this hierarchy was built for.
+		const Network& getNetwork() const;
+
+		/// Returns the number of undirected arcs of the hierarchy, i.e. network edges and shortcuts.
+		size_t getNumArcs() const;
+
+		/// Applies the given connection costs to the hierarchy.
+		/// \param	connectionCosts		Costs of each connection, indexed by Connection::getIndex(), infinity for unusable connections.
+		void customize(const std::vector<double>& connectionCosts);
+
+		/// Applies the costs used by the route search of vehicles with the given target velocity,
+		/// considering the congestion of all connections, see Routing::computeConnectionCosts().
+		void customize(const TrafficState& trafficState, double targetVelocity);
+
+		/// Computes the cheapest path from \e startNode to any of \e destinationNodes.
+		/// May be called concurrently for the same hierarchy.
+		/// \param	startNode			Start node
+		/// \param	destinationNodes	Destination nodes
+		/// \param	path				Receives the connections of the path, empty if no destination can be reached.
+		/// \return	Costs of the path, infinity if no destination can be reached.
+		double query(const Node& startNode, const std::vector<Node*>& destinationNodes, std::vector<const Connection*>& path) const;
+
+	private:
+		static const uint32_t noNode;
+
+		/// Returns the index of the arc from \e lower to \e upper in the upward arcs of \e lower.
+		size_t findArc(uint32_t lower, uint32_t upper) const;
+
+		/// Appends the connections represented by the arc from \e from to \e to to \e path.
+		void unpack(uint32_t from, uint32_t to, std::vector<const Connection*>& path) const;
+
+		const Network& m_network;					///< Network this hierarchy was built for.
+		size_t m_topologyRevision;					///< Topology revision of the network when the hierarchy was built.
+
+		std::vector<uint32_t> m_ranks;				///< Contraction rank of each node, indexed by Node::getIndex().
+		std::vector<uint32_t> m_order;				///< Node indices sorted by rank.
+
+		// Arcs of each node toward all neighbors of higher rank, stored as compressed rows sorted by the neighbor's index.
+		std::vector<uint32_t> m_firstArcs;			///< Index of the first upward arc of each node, plus one past the last arc.
+		std::vector<uint32_t> m_arcHeads;			///< Higher ranked node of each arc.
+		std::vector<double> m_upCosts;				///< Costs of each arc from the lower to the higher ranked node.
+		std::vector<double> m_downCosts;			///< Costs of each arc from the higher to the lower ranked node.
+		std::vector<uint32_t> m_upMiddles;			///< Node bypassed by the upward direction of a shortcut, noNode for network edges.
+		std::vector<uint32_t> m_downMiddles;		///< Node bypassed by the downward direction of a shortcut, noNode for network edges.
+	};
+
+}
+}
+
+#endif
@@ -3,7 +3,6 @@
 
 #include <cts-core/coreapi.h>
 
-#include <map>
 #include <memory>
 #include <vector>
 
@@ -15,9 +14,13 @@ namespace cts { namespace core
 	 * Represents a logical intersection between two network connections.
 	 * An Intersection is parameterized by the two connections intersecting and the its location
 	 * on them.
+	 * Vehicles crossing the intersection are not stored here but in the TrafficState of a 
+	 * Simulation, so that an Intersection can be shared by several simulations.
 	 */
 	class CTS_CORE_API Intersection
 	{
+		friend class Network;
+
 	public:
 		/// Structure storing information on a vehicle that is going to cross this intersection
 		struct CrossingVehicleInfo
@@ -25,7 +28,8 @@ namespace cts { namespace core
 			double originalArrivalTime;	///< Time when the vehicle originally planned to arrive at the intersection.
 			double remainingDistance;	///< Remaining distance of the vehicle to the intersection.
 			vec2 blockingTime;			///< Simulation time interval when the vehicle is going to block the intersection.
-			bool willWaitInFront;		///< Flag whether the vehicle is going to wait in front of the intersection.
+			bool willWaitInFront;		///< Flag whether the vehicle is going to wait in front of the intersection as published to other vehicles.
+			bool pendingWaitInFront;	///< Waiting decision of the current think phase, not yet visible to other vehicles.
 		};
 
 
@@ -60,31 +64,9 @@ namespace cts { namespace core
 		/// Return the distance vehicles should keep in case they need to wait in front.
 		double getWaitingDistance() const;
 
-
-		/// Registers \e vehicle with this intersection or updates the vehicles crossing info if it is already registered.
-		/// \param  vehicle				The vehicle that is going to use this intersection
-		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining this intersection.
-		/// \param  remainingDistance	Remaining distance of the vehicle to the intersection (arc length).
-		/// \param  blockingTime		Simulation time interval this vehicle will block the intersection.
-		void registerVehicle(const AbstractVehicle& vehicle, const Connection& connection, double remainingDistance, vec2 blockingTime);
-
-		/// Updates the waiting status how the given vehicle will interact with this intersection.
-		/// \param  vehicle				The vehicle that is going to use this intersection
-		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining this intersection.
-		/// \param  willWaitInFront		Flag whether the vehicle is going to wait in front of the intersection.
-		void updateVehicleWait(const AbstractVehicle& vehicle, const Connection& connection, bool willWaitInFront);
-
-		/// Unregisters \e vehicle with this intersection.
-		/// \param  vehicle				The vehicle to unregister. Must be registered.
-		/// \param  connection			The connection the vehicle used/planned to use. Must be one of the two connections defining this intersection.
-		void unregisterVehicle(const AbstractVehicle& vehicle, const Connection& connection);
-
-		/// Returns the list of all crossing entities that interfere with the given vehicle
-		/// \param  vehicle				The vehicle that is going to use this intersection, must be registered with this intersection.
-		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining this intersection.
-		std::vector<CrossingVehicleInfo> computeInterferingVehicles(const AbstractVehicle& vehicle, const Connection& connection);
-
-		CrossingVehicleInfo& getCrossingVehicleInfo(const AbstractVehicle& vehicle, const Connection& connection);
+		/// Returns the index of this intersection within its Network.
+		/// Traffic states use this index to store per-intersection data.
+		size_t getIndex() const;
 
 	private:
 		const Connection* m_aConnection;    ///< First network connection intersecting.
@@ -95,12 +77,7 @@ namespace cts { namespace core
 		double m_aArcPosition;              ///< Location of the intersection on aConnection in terms of arc length.
 		double m_bArcPosition;              ///< Location of the intersection on bConnection in terms of arc length.
 		double m_waitingDistance;           ///< Distance vehicles should keep in case they need to wait in front.
-
-	public:
-		/// List of all vehicles registered with the first network connection.
-		std::map<const AbstractVehicle*, CrossingVehicleInfo> m_aCrossingVehicles;
-		/// List of all vehicles registered with the second network connection.
-		std::map<const AbstractVehicle*, CrossingVehicleInfo> m_bCrossingVehicles;
+		size_t m_index;                     ///< Index of this intersection within its Network.
 	};
 }
 }
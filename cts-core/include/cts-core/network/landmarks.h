@@ -0,0 +1,79 @@
+#ifndef CTS_CORE_LANDMARKS_H__
+#define CTS_CORE_LANDMARKS_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Network;
+	class Node;
+	class TrafficState;
+
+	/**
+	 * Landmarks providing lower bounds of the route costs between two nodes of a network (ALT: A*, landmarks,
+	 * triangle inequality).
+	 *
+	 * For a few landmark nodes, the costs of the cheapest routes from and to every other node are precomputed,
+	 * using the uncongested costs of the connections for vehicles not limited by their own target velocity.
+	 * These never exceed the costs used by the route search, so the triangle inequality yields lower bounds
+	 * of the route costs between arbitrary nodes, which Routing::compute() uses as heuristic. The landmarks
+	 * are chosen automatically to be far away from each other, hence they are usually located at the border
+	 * of the network where they give tight bounds.
+	 */
+	class CTS_CORE_API Landmarks : public utils::NotCopyable
+	{
+	public:
+		/// Creates new Landmarks for the network of \e trafficState, call update() to compute them.
+		explicit Landmarks(const TrafficState& trafficState);
+
+		/// Returns the number of landmarks to choose, 0 if the landmarks are disabled.
+		size_t getNumLandmarks() const;
+		/// Sets the number of landmarks to choose, 0 to disable them. Takes effect with the next call to update().
+		void setNumLandmarks(size_t value);
+
+		/// Returns whether the landmarks are computed and can be used as heuristic.
+		bool isEnabled() const;
+
+		/// Returns the chosen landmark nodes.
+		const std::vector<const Node*>& getLandmarkNodes() const;
+
+		/// Recomputes the landmarks if nodes or connections were added or removed or the arc length or target
+		/// velocity of any connection changed, as tracked by Network::getTopologyRevision() and
+		/// Network::getCostRevision().
+		/// \return	Whether the landmarks were recomputed or cleared.
+		bool update();
+
+		/// Prepares the lower bounds toward \e destinationNodes for getLowerBound().
+		/// \param	destinationNodes	Destination nodes of the query.
+		/// \param	destinationBounds	Receives the combined landmark distances of all destination nodes.
+		void prepareQuery(const std::vector<Node*>& destinationNodes, std::vector<double>& destinationBounds) const;
+
+		/// Returns a lower bound of the route costs from \e node to the closest of the destination nodes.
+		/// \param	node				Node to start from.
+		/// \param	destinationBounds	Bounds computed by prepareQuery() for the destination nodes.
+		double getLowerBound(const Node& node, const std::vector<double>& destinationBounds) const;
+
+	private:
+		/// Computes the costs of the cheapest routes from (\e forward = true) or to all nodes starting at the given nodes.
+		void computeDistances(const std::vector<size_t>& sources, bool forward, std::vector<double>& distances) const;
+
+		const TrafficState& m_trafficState;			///< Traffic state owning the landmarks.
+		const Network& m_network;					///< Network of the landmarks.
+		size_t m_numLandmarks;						///< Number of landmarks to choose.
+		size_t m_topologyRevision;					///< Topology revision of the network when the landmarks were computed.
+		size_t m_costRevision;						///< Cost revision of the network when the landmarks were computed.
+		std::vector<double> m_connectionCosts;		///< Uncongested costs of each connection when the landmarks were computed.
+
+		std::vector<const Node*> m_landmarkNodes;	///< Chosen landmarks.
+		std::vector<double> m_distancesFrom;		///< Costs from each landmark to each node, indexed by Node::getIndex() * number of landmarks + landmark.
+		std::vector<double> m_distancesTo;			///< Costs from each node to each landmark, indexed by Node::getIndex() * number of landmarks + landmark.
+	};
+
+}
+}
+
+#endif
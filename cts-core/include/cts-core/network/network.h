@@ -6,8 +6,7 @@
 #include <cts-core/network/connection.h>
 #include <cts-core/network/intersection.h>
 #include <cts-core/network/node.h>
-#include <cts-core/traffic/trafficmanager.h>
-#include <cts-core/traffic/vehicle.h>
+#include <cts-core/traffic/trafficvolume.h>
 
 #include <memory>
 #include <vector>
@@ -15,20 +14,34 @@
 namespace cts { namespace core
 {
 
+	/**
+	 * Static description of a road network: its nodes, connections and their intersections as well
+	 * as the traffic volumes between them.
+	 * 
+	 * A Network is not modified by simulating it, all dynamic traffic is stored in the TrafficState
+	 * of a Simulation. Hence, several simulations can share the same network as long as it is not
+	 * edited concurrently.
+	 */
 	class CTS_CORE_API Network : public utils::NotCopyable
 	{
+		friend class Connection;
+
 	public:
 		using NodeListType = std::vector< std::unique_ptr<Node> >;
 		using ConnectionListType = std::vector< std::unique_ptr<Connection> >;
-		using VehicleListType = std::vector< std::unique_ptr<AbstractVehicle> >;
 		using IntersectionListType = std::vector< std::unique_ptr<Intersection> >;
+		using VolumeListType = std::vector< std::unique_ptr<TrafficVolume> >;
 
 
 		Network();
 		~Network();
 
 
-		void importLegacyXml(const std::string& filename);
+		/// Imports the nodes, connections and traffic volumes of a network saved by the original CityTrafficSimulator.
+		/// \param	filename	Path of the XML file to import.
+		/// \param	numThreads	Number of threads detecting the intersections, 0 to use the hardware concurrency.
+		///						The detected intersections do not depend on the number of threads.
+		void importLegacyXml(const std::string& filename, size_t numThreads = 0);
 
 		Node* addNode(const vec2& position);
 		void removeNode(Node& node);
@@ -45,23 +58,51 @@ namespace cts { namespace core
 		void removeConnection(Connection& connection);
 
 
-		TrafficManager& getTrafficManager();
+		/// Adds a new traffic volume from \e start toward \e destination.
+		/// \param  start			Start nodes where vehicles are supposed to spawn.
+		/// \param  destination		Destination nodes of the spawned vehicles.
+		TrafficVolume* addVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination);
+		/// Removes the given traffic volume from the network.
+		void removeVolume(TrafficVolume* volume);
+		/// Returns the list of all traffic volumes.
+		const VolumeListType& getVolumes() const;
+
+
 		const NodeListType& getNodes() const;
 		std::vector<Node*> getNodes(const Bounds2& bounds) const;
+		/// Returns the number of nodes, i.e. the upper bound of Node::getIndex().
+		size_t getNumNodes() const;
 		
 		std::vector< std::reference_wrapper<Connection> > getConnections() const;
-		const VehicleListType& getVehicles() const;
+		/// Returns the number of connections, i.e. the upper bound of Connection::getIndex().
+		size_t getNumConnections() const;
 		const IntersectionListType& getIntersections() const;
 
+		/// Returns a counter that is incremented whenever nodes or connections are added or removed.
+		/// Allows to detect whether data derived from the topology, e.g. cached routes, is outdated.
+		size_t getTopologyRevision() const;
+		/// Returns a counter that is incremented whenever the curve or target velocity of a connection changes.
+		/// Together with getTopologyRevision() it allows to detect whether uncongested route costs are outdated.
+		size_t getCostRevision() const;
+
 	private:
-		IntersectionListType computeIntersections(Connection& connection, ConnectionListType::iterator start, ConnectionListType::iterator end, double tolerance);
+		/// Computes the intersections between all connections and registers them with both connections.
+		/// The connections are processed concurrently, the results equal those of a sequential run.
+		/// \param	tolerance	Maximum size of the curve segments whose bounds are tested for intersections.
+		/// \param	numThreads	Total number of threads to use, 0 to use the hardware concurrency.
+		void computeIntersections(double tolerance, size_t numThreads);
 
-		TrafficManager m_trafficMgr;
+		/// Updates the indices of all nodes after the list of nodes was modified.
+		void updateNodeIndices();
+		/// Updates the indices of all connections after the list of connections was modified.
+		void updateConnectionIndices();
 
 		NodeListType m_nodes;
 		ConnectionListType m_connections;
-		VehicleListType m_vehicles;
 		IntersectionListType m_intersections;
+		VolumeListType m_volumes;
+		size_t m_topologyRevision;		///< See getTopologyRevision().
+		size_t m_costRevision;			///< See getCostRevision().
 
 		std::string m_title;
 		std::string m_description;
@@ -48,6 +48,10 @@ namespace cts { namespace core
 
 		Connection* getConnectionTo(const Node& targetNode) const;
 
+		/// Returns the index of this node within its Network.
+		/// Route planning uses this index to store per-node data.
+		size_t getIndex() const;
+
 
 	public:
 		Signal<Node*> s_deleted;
@@ -60,6 +64,8 @@ namespace cts { namespace core
 		std::vector<Connection*> m_incomingConnections;
 		std::vector<Connection*> m_outgoingConnections;
 
+		size_t m_index;		///< Index of this node within its Network.
+
 	};
 
 }
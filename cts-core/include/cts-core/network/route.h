@@ -0,0 +1,52 @@
+#ifndef CTS_CORE_ROUTE_H__
+#define CTS_CORE_ROUTE_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Connection;
+	class Node;
+
+	/**
+	 * Immutable sequence of connections leading from a start node toward a destination.
+	 *
+	 * Routes are shared between all vehicles following the same connections, see RouteStore, while each
+	 * vehicle only keeps track of its current segment in its Routing.
+	 */
+	class CTS_CORE_API Route : public utils::NotCopyable
+	{
+	public:
+		struct Segment
+		{
+			const Connection* connection;
+			const Node* start;
+			const Node* destination;
+			double costs;				///< Congestion-adjusted costs of the connection when the route was computed.
+		};
+
+		/// Creates a new Route consisting of the given segments.
+		explicit Route(std::vector<Segment> segments);
+
+		/// Returns all segments of this route.
+		const std::vector<Segment>& getSegments() const;
+
+		/// Returns a hash value of the connections and costs of all segments.
+		size_t getHash() const;
+
+		/// Returns whether \e other consists of the same connections with the same costs.
+		bool hasSameSegments(const Route& other) const;
+
+	private:
+		std::vector<Segment> m_segments;		///< Segments of this route.
+		size_t m_hash;							///< See getHash().
+	};
+
+}
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef CTS_CORE_ROUTESTORE_H__
+#define CTS_CORE_ROUTESTORE_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+#include <cts-core/network/route.h>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Node;
+	class TrafficState;
+
+	/**
+	 * Store of the routes used by the vehicles of a traffic state.
+	 *
+	 * Vehicles following identical routes, e.g. all vehicles of a TrafficVolume during light traffic,
+	 * share the same interned Route instead of each keeping its own copy of the segments. Interned routes
+	 * are reference-counted and released once no vehicle uses them anymore.
+	 *
+	 * Additionally, the store caches the result of each route query. Since the costs used by the route
+	 * search only change with TrafficState::getCongestionRevision(), identical queries for the same revision are
+	 * answered from the cache and yield exactly the route the search would have computed.
+	 *
+	 * The query cache only works with the cost snapshot of the traffic state (see
+	 * TrafficState::setCostSnapshotInterval()). With live costs, every vehicle entering or leaving a connection
+	 * changes the congestion revision, so cached results would hardly ever be reused. Hence, the cache is
+	 * bypassed in this case.
+	 */
+	class CTS_CORE_API RouteStore : public utils::NotCopyable
+	{
+	public:
+		/// Route query as answered by Routing::compute().
+		struct Query
+		{
+			size_t startIndex;							///< Node::getIndex() of the start node.
+			std::vector<size_t> destinationIndices;		///< Sorted Node::getIndex() of all destination nodes.
+			double targetVelocity;						///< Target velocity of the vehicle.
+
+			bool operator<(const Query& rhs) const;
+		};
+
+		/// Creates a new empty RouteStore.
+		/// \param	trafficState	Traffic state providing the revision of the costs used by the route search.
+		explicit RouteStore(const TrafficState& trafficState);
+
+		/// Returns the query for routes from \e startNode to any of \e destinationNodes for vehicles with the given target velocity.
+		static Query makeQuery(const Node& startNode, const std::vector<Node*>& destinationNodes, double targetVelocity);
+
+		/// Returns whether query results are cached, i.e. whether the route search uses the cost snapshot.
+		bool isQueryCacheEnabled() const;
+
+		/// Returns the route computed for \e query during the current revision of the traffic state, nullptr if there is none.
+		std::shared_ptr<const Route> find(const Query& query);
+
+		/// Caches \e route as result of \e query for the current revision of the traffic state.
+		/// Cached results of earlier revisions are discarded. Queries without a route are not cached, neither are
+		/// any queries if the query cache is disabled.
+		void insert(const Query& query, std::shared_ptr<const Route> route);
+
+		/// Returns the interned route with the same segments as \e route, which becomes the interned one if there is none yet.
+		std::shared_ptr<const Route> intern(const std::shared_ptr<const Route>& route);
+
+		/// Discards all cached query results.
+		void clear();
+
+		/// Returns the number of interned routes that are still in use.
+		size_t getNumRoutes() const;
+
+		/// Returns the number of queries answered from the cache so far.
+		size_t getNumQueryHits() const;
+
+	private:
+		/// Removes all interned routes that are not used anymore.
+		void purge();
+
+		const TrafficState& m_trafficState;		///< Traffic state providing the revision of the route costs.
+
+		std::unordered_multimap< size_t, std::weak_ptr<const Route> > m_routes;	///< Interned routes by Route::getHash().
+		size_t m_purgeSize;						///< Number of interned routes at which released routes are purged next.
+
+		std::map< Query, std::shared_ptr<const Route> > m_queries;	///< Cached query results of m_queryRevision.
+		size_t m_queryRevision;					///< Revision of the traffic state the cached query results belong to.
+		size_t m_numQueryHits;					///< See getNumQueryHits().
+	};
+
+}
+}
+
+#endif
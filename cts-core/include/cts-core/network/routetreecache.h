@@ -0,0 +1,90 @@
+#ifndef CTS_CORE_ROUTETREECACHE_H__
+#define CTS_CORE_ROUTETREECACHE_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+#include <cts-core/network/shortestpaths.h>
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Connection;
+	class Node;
+	class TrafficState;
+
+	/**
+	 * Cache of reverse shortest-path trees toward the destinations of the vehicles.
+	 *
+	 * All vehicles of a TrafficVolume share the same destination nodes. Instead of running a separate
+	 * search for each of them, the cache keeps one tree per set of destination nodes and target velocity
+	 * that stores the next connection and the remaining costs toward the destination for every node of
+	 * the network. Computing a route then only follows the next connections of the tree.
+	 *
+	 * In contrast to Routing::compute(), the trees consider the congestion of all connections at the time
+	 * they were computed. Trees are recomputed on demand once the refresh interval has passed or the
+	 * topology of the network has changed.
+	 */
+	class CTS_CORE_API RouteTreeCache : public utils::NotCopyable
+	{
+	public:
+		/// Shortest-path tree toward a set of destination nodes.
+		struct Tree
+		{
+			std::vector<double> costsToGo;						///< Remaining costs toward the destination, indexed by Node::getIndex(), infinite if it cannot be reached.
+			std::vector<const Connection*> nextConnections;		///< Next connection toward the destination, indexed by Node::getIndex(), nullptr at destinations and unreachable nodes.
+			bool outdated;										///< Flag whether the tree needs to be recomputed before its next use.
+		};
+
+
+		/// Creates a new empty RouteTreeCache.
+		/// \param	trafficState	Traffic state providing the network and the congestion of its connections.
+		explicit RouteTreeCache(const TrafficState& trafficState);
+
+		/// Returns whether vehicles are supposed to look up their routes in this cache.
+		bool isEnabled() const;
+
+		/// Returns the simulation time in s after which trees are recomputed, 0 if the cache is disabled.
+		double getRefreshInterval() const;
+		/// Sets the simulation time in s after which trees are recomputed, 0 to disable the cache.
+		void setRefreshInterval(double value);
+
+		/// Marks all trees as outdated if the refresh interval has passed or the network topology has changed.
+		/// \param	currentTime		Current simulation time.
+		void update(double currentTime);
+
+		/// Marks all trees as outdated.
+		void invalidate();
+
+		/// Returns the tree toward \e destinationNodes for vehicles with the given target velocity.
+		/// Computes the tree if it does not exist yet or is outdated, hence this must not be called concurrently.
+		const Tree& getTree(const std::vector<Node*>& destinationNodes, double targetVelocity);
+
+		/// Returns how many trees were computed so far.
+		size_t getNumTreeComputations() const;
+
+	private:
+		/// Destination node indices and target velocity identifying a tree.
+		using Key = std::pair<std::vector<size_t>, double>;
+
+		/// Computes \e tree toward the destination nodes with the given indices using a reverse Dijkstra search.
+		void computeTree(Tree& tree, const std::vector<size_t>& destinationIndices, double targetVelocity);
+
+		const TrafficState& m_trafficState;		///< Traffic state providing the network and the congestion.
+		std::map<Key, Tree> m_trees;			///< All cached trees.
+		Key m_key;								///< Scratch key for looking up trees without allocating.
+		OpenList m_openList;					///< Scratch open list of computeTree().
+
+		double m_refreshInterval;				///< See getRefreshInterval().
+		double m_lastRefreshTime;				///< Simulation time when the trees were invalidated the last time.
+		size_t m_topologyRevision;				///< Topology revision of the network when the trees were invalidated the last time.
+		size_t m_numTreeComputations;			///< Number of computed trees.
+	};
+
+}
+}
+
+#endif
@@ -2,33 +2,125 @@
 #define CTS_CORE_ROUTING_H__
 
 #include <cts-core/coreapi.h>
+#include <cts-core/network/route.h>
+#include <cts-core/network/routetreecache.h>
 
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace cts { namespace core
 {
 	class AbstractVehicle;
 	class Connection;
+	class ContractionHierarchy;
 	class Node;
+	class RouteStore;
+	class TrafficState;
 
 	class CTS_CORE_API Routing
 	{
 	public:
-		struct Segment
+		using Segment = Route::Segment;
+
+		/// View of the remaining segments of the route.
+		class SegmentRange
 		{
-			const Connection* connection;
-			const Node* start;
-			const Node* destination;
+		public:
+			const Segment* begin() const { return m_begin; }
+			const Segment* end() const { return m_end; }
+			size_t size() const { return m_end - m_begin; }
+			bool empty() const { return m_begin == m_end; }
+			const Segment& operator[](size_t index) const { return m_begin[index]; }
+			const Segment& front() const { return *m_begin; }
+			const Segment& back() const { return *(m_end - 1); }
+
+		private:
+			friend class Routing;
+			const Segment* m_begin = nullptr;
+			const Segment* m_end = nullptr;
 		};
 
 		Routing() = default;
 
+		/// Computes the route using an A* search. Uses the landmarks of the vehicle's traffic state as heuristic
+		/// if they are enabled, the air-line distance toward the closest destination node otherwise.
 		void compute(const Node& startNode, const std::vector<Node*>& destinationNodes, const AbstractVehicle& vehicle);
-		const std::vector<Segment>& getSegments() const;
+
+		/// Computes the route for vehicles with the given target velocity using an A* search.
+		/// Does not access any vehicle, hence it may run concurrently to the simulation as long as \e trafficState is not modified.
+		/// \param	startNode			Start node
+		/// \param	destinationNodes	Destination nodes
+		/// \param	trafficState		Traffic state providing the congestion of the connections.
+		/// \param	targetVelocity		Target velocity of the vehicle in m/s.
+		void compute(const Node& startNode, const std::vector<Node*>& destinationNodes, const TrafficState& trafficState, double targetVelocity);
+
+		/// Computes the route using a customized contraction hierarchy of the vehicle's network.
+		/// \param	hierarchy			Contraction hierarchy customized with the connection costs of the vehicle.
+		/// \param	startNode			Start node
+		/// \param	destinationNodes	Destination nodes
+		/// \param	vehicle				Vehicle to compute the route for.
+		void compute(const ContractionHierarchy& hierarchy, const Node& startNode, const std::vector<Node*>& destinationNodes, const AbstractVehicle& vehicle);
+
+		/// Computes the route by following the next connections of \e tree from \e startNode.
+		/// \param	tree		Shortest-path tree toward the destination nodes of the vehicle.
+		/// \param	startNode	Start node
+		/// \param	vehicle		Vehicle to compute the route for.
+		void follow(const RouteTreeCache::Tree& tree, const Node& startNode, const AbstractVehicle& vehicle);
+
+		/// Returns the remaining segments of the route, starting with the current connection of the vehicle.
+		const SegmentRange& getSegments() const;
+
+		/// Returns the route followed, nullptr if no route was found.
+		const std::shared_ptr<const Route>& getRoute() const;
+
+		/// Returns the index of the first remaining segment within getRoute().
+		size_t getSegmentIndex() const;
+
+		/// Sets the route to follow.
+		/// \param	route	Route to follow, nullptr to clear the route.
+		/// \param	index	Index of the first remaining segment within \e route.
+		void setRoute(std::shared_ptr<const Route> route, size_t index = 0);
+
+		/// Replaces the route by the identical one of \e store so that it is shared with other vehicles following it.
+		void intern(RouteStore& store);
+
+		/// Returns the number of nodes expanded by the last route search, 0 if no search was run.
+		size_t getNumExpandedNodes() const;
+
+		/// Removes the first segment from the route after the vehicle has left its connection.
+		void advance();
+
+		/// Replaces all segments after the first one by the segments of \e continuation, which needs to
+		/// start at the destination of the first segment.
+		void continueWith(const Routing& continuation);
+
+		/// Returns the relative change of the congestion-adjusted costs of the remaining route since it was computed.
+		/// Allows to keep the route as long as the traffic on it did not change materially instead of 
+		/// running a full search on every connection transition.
+		double computeCostChange(const AbstractVehicle& vehicle) const;
+
+		/// Returns the costs of \e connection for \e vehicle as used by the route search.
+		/// \param	connection	Connection to compute the costs for.
+		/// \param	vehicle		Vehicle using the connection.
+		/// \param	congested	Flag whether to add a penalty for the vehicles currently on \e connection.
+		static double computeConnectionCosts(const Connection& connection, const AbstractVehicle& vehicle, bool congested);
+
+		/// Returns the costs of \e connection for vehicles with the given target velocity as used by the route search.
+		/// Uses the snapshot of the congestion if enabled, see TrafficState::getCongestedArcLength().
+		static double computeConnectionCosts(const Connection& connection, const TrafficState& trafficState, double targetVelocity, bool congested);
+
+		/// Returns the arc length of \e connection plus the penalty for the given number of vehicles on it.
+		static double computeCongestedArcLength(const Connection& connection, size_t numVehicles);
 
 	private:
+		/// Replaces the route by the given segments.
+		void setSegments(std::vector<Segment> segments);
 
-		std::vector<Segment> m_segments;
+		std::shared_ptr<const Route> m_route;	///< See getRoute().
+		size_t m_index = 0;						///< See getSegmentIndex().
+		SegmentRange m_segments;				///< See getSegments().
+		size_t m_numExpandedNodes = 0;			///< See getNumExpandedNodes().
 
 	};
 
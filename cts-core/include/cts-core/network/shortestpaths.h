@@ -0,0 +1,187 @@
+#ifndef CTS_CORE_SHORTESTPATHS_H__
+#define CTS_CORE_SHORTESTPATHS_H__
+
+#include <cts-core/network/connection.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace cts { namespace core
+{
+	/**
+	 * Search state of each node of a route search, indexed by Node::getIndex().
+	 *
+	 * Entries are invalidated by incrementing a generation counter rather than by clearing them, so that a
+	 * search neither allocates nor touches the whole network in steady state.
+	 */
+	template<typename EntryT>
+	class NodeScratch
+	{
+	public:
+		/// Invalidates all entries and makes sure that there is an entry for each of \e numNodes nodes.
+		void reset(size_t numNodes)
+		{
+			if (m_slots.size() < numNodes)
+				m_slots.resize(numNodes, Slot{ 0, EntryT() });
+
+			if (++m_generation == 0)
+			{
+				// generation counter wrapped around, entries of old searches may look valid again
+				for (auto& slot : m_slots)
+					slot.generation = 0;
+				m_generation = 1;
+			}
+		}
+
+		/// Returns the entry of the node with the given index, nullptr if it was not visited since the last reset().
+		EntryT* find(size_t index)
+		{
+			Slot& slot = m_slots[index];
+			return (slot.generation == m_generation) ? &slot.entry : nullptr;
+		}
+
+		/// Returns the entry of the node with the given index, nullptr if it was not visited since the last reset().
+		const EntryT* find(size_t index) const
+		{
+			const Slot& slot = m_slots[index];
+			return (slot.generation == m_generation) ? &slot.entry : nullptr;
+		}
+
+		/// Marks the node with the given index as visited and returns its entry, which still holds its previous contents.
+		EntryT& visit(size_t index)
+		{
+			m_slots[index].generation = m_generation;
+			return m_slots[index].entry;
+		}
+
+		/// Returns the entry of the node with the given index, regardless of whether it was visited.
+		EntryT& get(size_t index)
+		{
+			return m_slots[index].entry;
+		}
+
+		/// Returns the entry of the node with the given index, regardless of whether it was visited.
+		const EntryT& get(size_t index) const
+		{
+			return m_slots[index].entry;
+		}
+
+	private:
+		/// Entry of a single node together with the search it belongs to.
+		struct Slot
+		{
+			uint32_t generation;	///< Search the entry belongs to, the node is unvisited if it differs from the current one.
+			EntryT entry;			///< Search state of the node.
+		};
+
+		std::vector<Slot> m_slots;		///< Entries of all nodes.
+		uint32_t m_generation = 0;		///< Current search, see Slot::generation.
+	};
+
+
+	/**
+	 * Open list of a Dijkstra search with lazy deletion.
+	 *
+	 * Instead of decreasing the key of a node, the node is pushed again with its new costs, outdated elements
+	 * are skipped by the search when popped. Ties are broken by the node index to keep searches deterministic.
+	 */
+	class OpenList
+	{
+	public:
+		/// Costs and Node::getIndex() of a node in the open list.
+		using Element = std::pair<double, uint32_t>;
+
+		/// Returns whether the open list is empty.
+		bool empty() const
+		{
+			return m_heap.empty();
+		}
+
+		/// Removes all elements.
+		void clear()
+		{
+			m_heap.clear();
+		}
+
+		/// Adds the node with the given index and costs.
+		void push(double costs, uint32_t index)
+		{
+			m_heap.push_back(Element(costs, index));
+			std::push_heap(m_heap.begin(), m_heap.end(), std::greater<Element>());
+		}
+
+		/// Removes and returns the cheapest element.
+		Element pop()
+		{
+			assert(!m_heap.empty());
+			std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Element>());
+			const Element toReturn = m_heap.back();
+			m_heap.pop_back();
+			return toReturn;
+		}
+
+	private:
+		std::vector<Element> m_heap;	///< Binary min-heap of all elements.
+	};
+
+
+	/// Computes the costs of the cheapest paths from (\e forward = true) or toward the closest of the source nodes
+	/// for all nodes of \e network, using Dijkstra's algorithm.
+	/// \param	network			Network to search.
+	/// \param	sources			Node::getIndex() of the source nodes.
+	/// \param	forward			Whether to follow the outgoing connections starting at the sources or the incoming ones toward them.
+	/// \param	connectionCosts	Function returning the non-negative costs of a connection.
+	/// \param	openList		Scratch open list, may be reused between searches to not allocate.
+	/// \param	distances		Receives the costs of each node, indexed by Node::getIndex(), infinite if it cannot be reached.
+	/// \param	connections		Receives the connection of each node on its cheapest path, indexed by Node::getIndex(),
+	///							nullptr at the sources and unreachable nodes. Not computed if nullptr.
+	template<typename ConnectionCostsT>
+	void computeShortestPaths(const Network& network, const std::vector<size_t>& sources, bool forward, ConnectionCostsT&& connectionCosts,
+		OpenList& openList, std::vector<double>& distances, std::vector<const Connection*>* connections = nullptr)
+	{
+		const auto& nodes = network.getNodes();
+		distances.assign(nodes.size(), std::numeric_limits<double>::infinity());
+		if (connections != nullptr)
+			connections->assign(nodes.size(), nullptr);
+
+		openList.clear();
+		for (size_t source : sources)
+		{
+			distances[source] = 0.0;
+			openList.push(0.0, uint32_t(source));
+		}
+
+		while (!openList.empty())
+		{
+			const OpenList::Element ole = openList.pop();
+			if (ole.first > distances[ole.second])
+				continue;
+
+			const Node& node = *nodes[ole.second];
+			for (const Connection* connection : (forward ? node.getOutgoingConnections() : node.getIncomingConnections()))
+			{
+				const size_t otherIndex = (forward ? connection->getEndNode() : connection->getStartNode()).getIndex();
+				const double distance = ole.first + connectionCosts(*connection);
+				if (distance < distances[otherIndex])
+				{
+					distances[otherIndex] = distance;
+					if (connections != nullptr)
+						(*connections)[otherIndex] = connection;
+					openList.push(distance, uint32_t(otherIndex));
+				}
+			}
+		}
+	}
+
+}
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef CTS_CORE_RENDERSNAPSHOT_H__
+#define CTS_CORE_RENDERSNAPSHOT_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/math.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace cts { namespace core
+{
+	/**
+	 * Compact, render-ready description of a single vehicle.
+	 * All values are already converted into world coordinates so that renderers do not need to
+	 * access the network or the vehicle itself.
+	 */
+	struct VehicleSnapshot
+	{
+		/// Coarse driving state of the vehicle, e.g. for color coding.
+		enum class DrivingState : uint8_t
+		{
+			Driving,	///< Vehicle is accelerating or keeping its velocity.
+			Braking,	///< Vehicle is decelerating.
+			Stopped		///< Vehicle is standing still.
+		};
+
+		int id;					///< Identifier of the vehicle.
+		vec2 position;			///< World position of the vehicle's front.
+		vec2 heading;			///< Normalized driving direction in world coordinates.
+		double length;			///< Length of the vehicle.
+		DrivingState state;		///< Coarse driving state of the vehicle.
+	};
+
+
+	/**
+	 * Snapshot of all vehicles of a Simulation after a single step.
+	 */
+	struct RenderSnapshot
+	{
+		RenderSnapshot()
+			: time(0.0)
+		{}
+
+		double time;								///< Simulation time of this snapshot.
+		std::vector<VehicleSnapshot> vehicles;		///< All vehicles currently in the network.
+	};
+
+}
+}
+
+#endif
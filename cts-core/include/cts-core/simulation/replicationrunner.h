@@ -0,0 +1,108 @@
+#ifndef CTS_CORE_REPLICATIONRUNNER_H__
+#define CTS_CORE_REPLICATIONRUNNER_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+#include <cts-core/traffic/trafficmanager.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Network;
+
+	/**
+	 * Runs several replications of the same scenario with different random seeds in parallel.
+	 *
+	 * The scenario network is loaded and prepared only once and shared by all replications, each 
+	 * replication only has its own Simulation with its own TrafficState. Replications are distributed 
+	 * among the threads of a ThreadPool, each replication runs single-threaded.
+	 * Since every replication only depends on its seed, the results do not depend on the number of 
+	 * threads.
+	 */
+	class CTS_CORE_API ReplicationRunner : public utils::NotCopyable
+	{
+	public:
+		/// Result of a single replication.
+		struct Result
+		{
+			uint32_t seed;							///< Random seed of this replication.
+			double simulatedTime;					///< Simulated time in s.
+			size_t numTicks;						///< Number of simulation steps performed.
+			double wallTime;						///< Wall-clock time spent on this replication in s.
+			size_t numRemainingVehicles;			///< Number of vehicles still in the network at the end.
+			TrafficManager::Statistics statistics;	///< Statistics of the TrafficManager at the end.
+		};
+
+		/// Report on all replications of a single run() call.
+		struct Report
+		{
+			std::vector<Result> results;			///< Results of all replications in the order of the given seeds.
+			double wallTime;						///< Wall-clock time spent on all replications in s.
+		};
+
+
+		/// Creates a new ReplicationRunner for the given scenario.
+		/// \param	network		Network to simulate, must not be modified while run() is executing.
+		explicit ReplicationRunner(const Network& network);
+
+
+		/// Returns the simulated duration of each replication in s.
+		double getDuration() const;
+		/// Sets the simulated duration of each replication in s.
+		void setDuration(double value);
+
+		/// Returns the number of simulation steps per simulated second.
+		double getTicksPerSecond() const;
+		/// Sets the number of simulation steps per simulated second.
+		void setTicksPerSecond(double value);
+
+		/// Returns the multiplier for the global traffic volume.
+		double getTrafficMultiplier() const;
+		/// Sets the multiplier for the global traffic volume.
+		void setTrafficMultiplier(double value);
+
+		/// Returns the refresh interval of the cached shortest-path trees, see TrafficManager::getRouteTreeInterval().
+		double getRouteTreeInterval() const;
+		/// Sets the refresh interval of the cached shortest-path trees, see TrafficManager::setRouteTreeInterval().
+		void setRouteTreeInterval(double value);
+
+		/// Returns the refresh interval of the connection cost snapshot, see TrafficManager::getCostSnapshotInterval().
+		double getCostSnapshotInterval() const;
+		/// Sets the refresh interval of the connection cost snapshot, see TrafficManager::setCostSnapshotInterval().
+		void setCostSnapshotInterval(double value);
+
+		/// Returns whether vehicles plan new routes asynchronously, see TrafficManager::isAsyncRouting().
+		bool isAsyncRouting() const;
+		/// Sets whether vehicles plan new routes asynchronously, see TrafficManager::setAsyncRouting().
+		void setAsyncRouting(bool value);
+
+		/// Returns the number of replications to run concurrently.
+		size_t getNumThreads() const;
+		/// Sets the number of replications to run concurrently, 0 to use the hardware concurrency.
+		void setNumThreads(size_t value);
+
+
+		/// Runs one replication per given seed and blocks until all of them are finished.
+		/// \param	seeds	Random seeds of the replications.
+		Report run(const std::vector<uint32_t>& seeds) const;
+
+	private:
+		/// Runs a single replication with the given seed.
+		Result runReplication(uint32_t seed) const;
+
+		const Network& m_network;		///< Scenario network shared by all replications.
+		double m_duration;				///< Simulated duration of each replication in s.
+		double m_ticksPerSecond;		///< Number of simulation steps per simulated second.
+		double m_trafficMultiplier;		///< Multiplier for the global traffic volume.
+		double m_routeTreeInterval;		///< Refresh interval of the cached shortest-path trees in s, 0 to disable them.
+		double m_costSnapshotInterval;	///< Refresh interval of the connection cost snapshot in s, 0 to use the live traffic.
+		bool m_asyncRouting;			///< Flag whether vehicles plan new routes asynchronously.
+		size_t m_numThreads;			///< Number of replications to run concurrently, 0 for hardware concurrency.
+	};
+
+}
+}
+
+#endif
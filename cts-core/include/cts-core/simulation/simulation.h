@@ -3,7 +3,10 @@
 
 #include <cts-core/coreapi.h>
 #include <cts-core/base/signal.h>
+#include <cts-core/base/triplebuffer.h>
+#include <cts-core/simulation/rendersnapshot.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
@@ -16,13 +19,37 @@ namespace cts { namespace core
 {
 	class Network;
 	class Randomizer;
+	class TrafficManager;
+	class TrafficState;
 
 	class CTS_CORE_API Simulation : public utils::NotCopyable
 	{
 	public:
-		Simulation(Network& network);
+		/// Scheduling modes for the background simulation started by start().
+		enum class PacingMode
+		{
+			RealTime,		///< Steps are scheduled on absolute deadlines so that simulated time runs at getSpeed() times wall-clock time.
+			Unthrottled		///< Steps are performed as fast as possible.
+		};
+
+
+		/// Creates a new Simulation of the given network.
+		/// The network is never modified by the simulation, hence several simulations may share it.
+		/// \param	network		Network to simulate, must outlive the Simulation.
+		Simulation(const Network& network);
 		~Simulation();
 
+		/// Returns the simulated network.
+		const Network& getNetwork() const;
+
+		/// Returns the TrafficManager spawning and owning the vehicles of this Simulation.
+		TrafficManager& getTrafficManager();
+		/// Returns the TrafficManager spawning and owning the vehicles of this Simulation.
+		const TrafficManager& getTrafficManager() const;
+
+		/// Returns the dynamic traffic state of this Simulation.
+		const TrafficState& getTrafficState() const;
+
 		/// Returns the randomizer used to generate deterministic random numbers for this Simulation.
 		const Randomizer& getRandomizer() const;
 
@@ -41,6 +68,32 @@ namespace cts { namespace core
 		/// Sets the number of simulation steps per simulated second.
 		void setTicksPerSecond(double value);
 
+		/// Returns the scheduling mode of the background simulation.
+		PacingMode getPacingMode() const;
+		/// Sets the scheduling mode of the background simulation, may be changed while the simulation is running.
+		void setPacingMode(PacingMode value);
+
+		/// Returns the maximum number of ticks the simulation tries to catch up after falling behind its schedule.
+		int getMaxCatchUpTicks() const;
+		/// Sets the maximum number of ticks the simulation tries to catch up after falling behind its schedule.
+		/// If the simulation falls further behind, the schedule is reset instead of running steps back-to-back.
+		void setMaxCatchUpTicks(int value);
+
+		/// Returns the measured ratio of simulated time to wall-clock time of the background simulation.
+		/// In RealTime mode, a value below getSpeed() indicates that the simulation cannot keep up.
+		double getRealTimeFactor() const;
+
+		/// Returns whether a RenderSnapshot is published after each step.
+		bool getRenderSnapshotsEnabled() const;
+		/// Sets whether a RenderSnapshot should be published after each step.
+		void setRenderSnapshotsEnabled(bool value);
+
+		/// Fetches and returns the latest RenderSnapshot published after a simulation step.
+		/// Never blocks the simulation thread, hence renderers do not need to lock getMutex().
+		/// \note	Must only be called from a single consumer thread. The returned reference stays valid 
+		///			until the next call of this function.
+		const RenderSnapshot& fetchRenderSnapshot();
+
 		/// Resets the entire simulation
 		void reset(uint32_t randomSeed);
 
@@ -61,18 +114,29 @@ namespace cts { namespace core
 	private:
 		void simulationLoop();
 
-		double m_speed;
+		/// Fills the write buffer of m_renderSnapshots with the current vehicles and publishes it.
+		void publishRenderSnapshot();
+
+		std::atomic<double> m_speed;
 		double m_ticksPerSecond;
 		double m_duration;
+		std::atomic<PacingMode> m_pacingMode;
+		std::atomic<int> m_maxCatchUpTicks;
+		std::atomic<double> m_realTimeFactor;		///< Measured ratio of simulated time to wall-clock time.
 
 		double m_currentTime;
-		bool m_stopSimulation;
+		std::atomic<bool> m_stopSimulation;
 
 		std::unique_ptr<std::thread> m_simulationThread;
 		std::unique_ptr<Randomizer> m_randomizer;
-		Network& m_network;
+		const Network& m_network;
+		std::unique_ptr<TrafficState> m_trafficState;		///< Dynamic traffic state, must outlive m_trafficManager.
+		std::unique_ptr<TrafficManager> m_trafficManager;	///< Manager spawning and owning all vehicles.
 
 		std::mutex m_mutex;
+
+		std::atomic<bool> m_renderSnapshotsEnabled;			///< Flag whether to publish a RenderSnapshot after each step.
+		TripleBuffer<RenderSnapshot> m_renderSnapshots;		///< Render snapshots handed over to the renderer.
 	};
 
 
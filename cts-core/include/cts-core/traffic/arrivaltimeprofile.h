@@ -0,0 +1,78 @@
+#ifndef CTS_CORE_ARRIVALTIMEPROFILE_H__
+#define CTS_CORE_ARRIVALTIMEPROFILE_H__
+
+#include <cts-core/coreapi.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace cts { namespace core
+{
+	/**
+	 * Tabulated free-road trajectory of a vehicle for estimating arrival times.
+	 *
+	 * Integrates the free-road acceleration of a driving model in steps of one second and stores the
+	 * covered distance after each step. Arrival times are then looked up in the table instead of 
+	 * integrating the trajectory again for every distance. The table is extended lazily as far as the
+	 * queried distances require and recomputed whenever the start or desired velocity changes. 
+	 * The results are identical to integrating the trajectory for each query.
+	 */
+	class CTS_CORE_API ArrivalTimeProfile
+	{
+	public:
+		/// Creates an empty profile.
+		ArrivalTimeProfile();
+
+		/// Returns the time in s needed to cover \e distance.
+		/// \param	velocity				Velocity in m/s at time 0.
+		/// \param	desiredVelocity			Desired velocity in m/s.
+		/// \param	distance				Distance in m.
+		/// \param	freeRoadAcceleration	Callable returning the free-road acceleration for a given velocity and 
+		///									desired velocity. Must be the same for all calls to this profile.
+		template<typename FreeRoadAccelerationT>
+		double getArrivalTime(double velocity, double desiredVelocity, double distance, FreeRoadAccelerationT&& freeRoadAcceleration);
+
+		/// Returns the number of integration steps stored in the table.
+		size_t getNumSteps() const;
+
+	private:
+		/// Discards the table and restarts the profile with the given velocities.
+		void reset(double velocity, double desiredVelocity);
+
+		/// Looks up the arrival time for \e distance, which must be covered by the table.
+		double lookup(double distance) const;
+
+		double m_velocity;					///< Velocity at time 0.
+		double m_desiredVelocity;			///< Desired velocity of the tabulated trajectory.
+		std::vector<double> m_velocities;	///< Velocity at the end of each step.
+		std::vector<double> m_distances;	///< Covered distance at the end of each step.
+	};
+
+
+	// ================================================================================================
+
+
+	template<typename FreeRoadAccelerationT>
+	double ArrivalTimeProfile::getArrivalTime(double velocity, double desiredVelocity, double distance, FreeRoadAccelerationT&& freeRoadAcceleration)
+	{
+		if (distance < 0.0)
+			return 0.0;
+
+		if (velocity != m_velocity || desiredVelocity != m_desiredVelocity)
+			reset(velocity, desiredVelocity);
+
+		while (m_distances.empty() || m_distances.back() <= distance)
+		{
+			const double currentVelocity = m_velocities.empty() ? m_velocity : m_velocities.back();
+			const double newVelocity = currentVelocity + freeRoadAcceleration(currentVelocity, m_desiredVelocity);
+			m_velocities.push_back(newVelocity);
+			m_distances.push_back((m_distances.empty() ? 0.0 : m_distances.back()) + newVelocity);
+		}
+
+		return lookup(distance);
+	}
+
+}
+}
+
+#endif
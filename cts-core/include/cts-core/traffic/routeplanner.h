@@ -0,0 +1,105 @@
+#ifndef CTS_CORE_ROUTEPLANNER_H__
+#define CTS_CORE_ROUTEPLANNER_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+#include <cts-core/network/routestore.h>
+#include <cts-core/network/routing.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class AbstractVehicle;
+	class Node;
+	class ThreadPool;
+	class TrafficState;
+
+	/**
+	 * Plans the routes of vehicles on the worker threads of a ThreadPool instead of the simulation thread.
+	 *
+	 * Vehicles request a new route while moving on to their next connection and keep following their
+	 * remaining route meanwhile. TrafficManager dispatches all requests of a tick once the vehicles have
+	 * moved, the routes are then computed while the simulation thread finishes the tick. They are delivered
+	 * at the beginning of the next tick in the order they were requested. Since the traffic state is not
+	 * modified in between, the results do not depend on the number of threads or their timing.
+	 *
+	 * Requests that were already answered during the current congestion revision are looked up in the
+	 * RouteStore of the traffic state, identical requests within a tick are computed only once.
+	 */
+	class CTS_CORE_API RoutePlanner : public utils::NotCopyable
+	{
+	public:
+		/// Creates a new RoutePlanner for vehicles moving in \e trafficState.
+		explicit RoutePlanner(TrafficState& trafficState);
+
+		/// Waits for all dispatched requests, see cancel().
+		~RoutePlanner();
+
+		/// Requests a new route for \e vehicle continuing its current connection.
+		/// Must not be called while requests are dispatched.
+		/// \param	vehicle				Vehicle to plan the route for, needs to stay alive until the route was delivered.
+		/// \param	startNode			Node to start the route at, i.e. the end node of the vehicle's current connection.
+		/// \param	destinationNodes	Destination nodes of the vehicle, need to stay alive until the route was delivered.
+		void request(AbstractVehicle& vehicle, const Node& startNode, const std::vector<Node*>& destinationNodes);
+
+		/// Returns the number of requests that were not delivered yet.
+		size_t getNumPendingRequests() const;
+
+		/// Starts computing all pending requests on the worker threads of \e threadPool.
+		/// The traffic state must not be modified until the requests were delivered or canceled.
+		void dispatch(ThreadPool& threadPool);
+
+		/// Blocks until all dispatched requests were computed.
+		void wait();
+
+		/// Waits for all dispatched requests and hands the computed routes to their vehicles in the order
+		/// they were requested.
+		/// \return	Number of delivered routes.
+		size_t deliver();
+
+		/// Waits for all dispatched requests and discards them, e.g. before the vehicles are removed.
+		void cancel();
+
+	private:
+		/// Route search requested by a vehicle.
+		struct Request
+		{
+			AbstractVehicle* vehicle;						///< Vehicle that requested the route.
+			const Node* startNode;							///< Node to start the route at.
+			const std::vector<Node*>* destinationNodes;		///< Destination nodes of the vehicle.
+			double targetVelocity;							///< Target velocity of the vehicle at the time of the request.
+			RouteStore::Query query;						///< Query of the requested route.
+			size_t source;									///< Index of the request providing the route, this one unless it is a duplicate.
+			Routing routing;								///< Computed route.
+		};
+
+		/// Answers pending requests from the RouteStore and determines the requests that need to be computed.
+		void prepareRequests();
+
+		/// Computes dispatched requests until there are none left, may be called concurrently.
+		void processRequests();
+
+		TrafficState& m_trafficState;			///< Traffic state the vehicles move in.
+		std::vector<Request> m_requests;		///< Pending requests in the order they were requested.
+		std::vector<size_t> m_searches;			///< Indices of the pending requests that need a route search.
+		std::map<RouteStore::Query, size_t> m_queries;	///< Index of the first pending request of each query.
+		size_t m_congestionRevision;			///< Congestion revision of the traffic state when the requests were prepared.
+		bool m_prepared;						///< Flag whether prepareRequests() was called for the pending requests.
+		bool m_dispatched;						///< Flag whether the pending requests were dispatched.
+
+		std::atomic<size_t> m_nextRequest;		///< Index into m_searches of the next dispatched request to compute.
+		size_t m_numRunningTasks;				///< Number of tasks computing the dispatched requests.
+		std::mutex m_mutex;						///< Mutex protecting m_numRunningTasks.
+		std::condition_variable m_done;			///< Condition variable signalling that all tasks have finished.
+	};
+
+}
+}
+
+#endif
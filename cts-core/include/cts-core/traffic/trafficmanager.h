@@ -4,41 +4,50 @@
 #include <cts-core/coreapi.h>
 #include <cts-core/base/signal.h>
 #include <cts-core/base/utils.h>
-#include <cts-core/network/location.h>
+#include <cts-core/traffic/trafficvolume.h>
+#include <cts-core/traffic/vehiclebatch.h>
 
+#include <array>
 #include <memory>
 #include <vector>
 
 namespace cts { namespace core
 {
 	class AbstractVehicle;
+	class Network;
+	class RoutePlanner;
 	class Simulation;
+	class ThreadPool;
+	class TrafficState;
 
 	/**
 	 * Manager class for the traffic of the network. 
 	 * 
-	 * TrafficManager takes care of spawning vehicles according to the configured traffic density.
+	 * TrafficManager takes care of spawning vehicles according to the traffic volumes of the network
+	 * and owns all vehicles of a single Simulation. The vehicles of each vehicle type are additionally
+	 * kept in a homogeneous VehicleBatch, so that the think phase calls the driving models without 
+	 * any virtual dispatch.
 	 */
 	class CTS_CORE_API TrafficManager : public utils::NotCopyable
 	{
 	public:
-		/// Structure describing the traffic volume from a given location toward a given destination.
-		struct TrafficVolume : public utils::NotCopyable
+		/// Structure aggregating statistics on all vehicles handled by the TrafficManager.
+		struct Statistics
 		{
-			TrafficVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination);
-
-			Location start;			///< Start nodes where vehicles are supposed to spawn.
-			Location destination;	///< Destination nodes of the spawned vehicles.
-			int carsPerHour;		///< Traffic density for cars.
-
-			// FIXME: do not have a fixed set of vehicle classes but use some cool tag system
-			int trucksPerHour;		///< Traffic density for trucks.
-			int busesPerHour;		///< Traffic density for buses.
-			int tramsPerHour;		///< Traffic density for trams.
+			size_t numSpawnedVehicles;		///< Number of vehicles spawned so far.
+			size_t numArrivedVehicles;		///< Number of vehicles that have reached their destination.
+			double totalTravelTime;			///< Accumulated travel time of all arrived vehicles in s.
+			double totalTravelDistance;		///< Accumulated travel distance of all arrived vehicles in dm.
+			size_t numRegistrationOverflows;	///< Number of times a vehicle had more intersections within its lookahead distance than AbstractVehicle::registrationWindowCapacity.
+			size_t numRouteComputations;	///< Number of full route searches, including the initial ones of spawned vehicles.
+			size_t numRouteRepairs;			///< Number of connection transitions where a vehicle kept its remaining route.
 		};
 
 
-		TrafficManager();
+		/// Creates a new TrafficManager.
+		/// \param	network			Network providing the traffic volumes.
+		/// \param	trafficState	Traffic state the spawned vehicles move in.
+		TrafficManager(const Network& network, TrafficState& trafficState);
 		~TrafficManager();
 
 
@@ -47,12 +56,58 @@ namespace cts { namespace core
 		/// Sets the multiplier for the global traffic volume.
 		void setGlobalTrafficMultiplier(double value);
 
+		/// Returns the number of threads used to process the think phase of the vehicles.
+		/// Defaults to 1, so that no worker threads are started unless requested.
+		size_t getNumThreads() const;
+		/// Sets the number of threads used to process the think phase of the vehicles, 0 to use the hardware concurrency.
+		/// The simulation results do not depend on the number of threads.
+		void setNumThreads(size_t value);
+
+		/// Returns the route repair threshold of spawned vehicles, see AbstractVehicle::getRouteRepairThreshold().
+		double getRouteRepairThreshold() const;
+		/// Sets the route repair threshold of vehicles spawned from now on, see AbstractVehicle::setRouteRepairThreshold().
+		void setRouteRepairThreshold(double value);
+
+		/// Returns the simulation time in s after which the cached shortest-path trees are recomputed, 0 if vehicles search their routes individually.
+		double getRouteTreeInterval() const;
+		/// Sets the simulation time in s after which the cached shortest-path trees are recomputed, see RouteTreeCache.
+		/// 0 disables the cache so that each vehicle searches its route individually.
+		void setRouteTreeInterval(double value);
+
+		/// Returns the simulation time in s after which the snapshot of the connection costs is refreshed, 0 if the route search uses the live traffic.
+		double getCostSnapshotInterval() const;
+		/// Sets the simulation time in s after which the snapshot of the connection costs used by the route search
+		/// is refreshed, see TrafficState::setCostSnapshotInterval(). 0 lets the route search use the live traffic.
+		void setCostSnapshotInterval(double value);
+
+		/// Returns whether spawned vehicles plan new routes asynchronously, see RoutePlanner.
+		bool isAsyncRouting() const;
+		/// Sets whether vehicles spawned from now on plan new routes on the worker threads. They then keep following
+		/// their remaining route until the new one is delivered at the beginning of the next tick, see RoutePlanner.
+		void setAsyncRouting(bool value);
+
+		/// Registers the driving model and target velocity for spawning vehicles of the given type.
+		/// By default, only cars are spawned using IdmMobil. Returns false without changing anything if
+		/// there are any vehicles, since their batch would be destroyed.
+		/// \param	type			Vehicle type to spawn according to the traffic volumes.
+		/// \param	targetVelocity	Target velocity of the spawned vehicles in m/s.
+		template<typename DrivingModelT>
+		bool registerVehicleType(VehicleType type, double targetVelocity);
+
+		/// Stops spawning vehicles of the given type.
+		/// Returns false without changing anything if there are any vehicles, since their batch would be destroyed.
+		bool unregisterVehicleType(VehicleType type);
+
+		/// Returns whether vehicles of the given type are spawned.
+		bool isVehicleTypeRegistered(VehicleType type) const;
+
+		/// Removes all vehicles from the network.
 		void clearVehicles();
 
-
-		TrafficVolume* addVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination);
-		void removeVolume(TrafficVolume* volume);
-		const std::vector< std::unique_ptr<TrafficVolume> >& getVolumes() const;
+		/// Returns the statistics on all vehicles handled so far.
+		const Statistics& getStatistics() const;
+		/// Resets all statistics to zero.
+		void resetStatistics();
 
 
 		const std::vector< std::unique_ptr<AbstractVehicle> >& getVehicles() const;
@@ -63,18 +118,51 @@ namespace cts { namespace core
 		Signal<AbstractVehicle*> s_vehicleSpawned;
 
 	private:
+		/// Vehicle waiting to be spawned.
+		struct PendingVehicle
+		{
+			const TrafficVolume* volume;	///< Traffic volume the vehicle belongs to.
+			VehicleType type;				///< Type of the vehicle.
+		};
+
+		/// Returns whether the vehicle types may be changed, i.e. whether there are no vehicles. Logs a warning otherwise.
+		bool canChangeVehicleTypes() const;
+
 		void spawnVehicles(const Simulation& simulation, double tickLength);
 		void tickVehicles(const Simulation& simulation, double tickLength);
 
 
-		std::vector< std::unique_ptr<TrafficVolume> > m_volumes;
-		std::vector< std::unique_ptr<AbstractVehicle> > m_vehicles;
-		std::vector< TrafficVolume* > m_vehiclesToSpawn;
+		const Network& m_network;				///< Network providing the traffic volumes.
+		TrafficState& m_trafficState;			///< Traffic state the vehicles move in.
+
+		std::vector< std::unique_ptr<AbstractVehicle> > m_vehicles;	///< Owns all vehicles, their hot data is kept in the VehicleStore.
+		std::vector<PendingVehicle> m_vehiclesToSpawn;
+		std::array<std::unique_ptr<AbstractVehicleBatch>, numVehicleTypes> m_batches;	///< Batch of each registered vehicle type.
+		std::vector<size_t> m_leavingVehicles;	///< Vehicles leaving their connection during the current tick.
 
 		double m_globalTrafficMultiplier;
+		double m_routeRepairThreshold;			///< Route repair threshold of spawned vehicles.
+		bool m_asyncRouting;					///< Flag whether spawned vehicles plan new routes asynchronously.
+		Statistics m_statistics;
 
+		std::unique_ptr<RoutePlanner> m_routePlanner;	///< Planner computing the routes requested during a tick.
+		std::unique_ptr<ThreadPool> m_threadPool;	///< Thread pool used to process the think phase and the route requests concurrently.
 	};
 
+
+	// ================================================================================================
+
+
+	template<typename DrivingModelT>
+	bool TrafficManager::registerVehicleType(VehicleType type, double targetVelocity)
+	{
+		if (!canChangeVehicleTypes())
+			return false;
+
+		m_batches[size_t(type)] = std::make_unique< VehicleBatch<DrivingModelT> >(targetVelocity);
+		return true;
+	}
+
 }
 }
 
@@ -0,0 +1,309 @@
+#ifndef CTS_CORE_TRAFFICSTATE_H__
+#define CTS_CORE_TRAFFICSTATE_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/math.h>
+#include <cts-core/base/types.h>
+#include <cts-core/base/utils.h>
+#include <cts-core/network/intersection.h>
+#include <cts-core/network/landmarks.h>
+#include <cts-core/network/routestore.h>
+#include <cts-core/network/routetreecache.h>
+#include <cts-core/traffic/vehiclestore.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class AbstractVehicle;
+	class Connection;
+	class Network;
+
+	/**
+	 * Dynamic traffic state of a single simulation run on a Network.
+	 *
+	 * The Network itself only describes the static topology and geometry and is never modified by a
+	 * simulation. All data changing while vehicles move through the network, i.e. the vehicles on each
+	 * connection and the vehicles registered with each intersection, is stored here in arrays indexed
+	 * by Connection::getIndex() and Intersection::getIndex(). Hence, several simulations may share the
+	 * same Network, each one using its own TrafficState. The dynamic state of the vehicles themselves
+	 * is kept in the VehicleStore.
+	 */
+	class CTS_CORE_API TrafficState : public utils::NotCopyable
+	{
+	public:
+		// TODO: consider making vehicles const
+		using VehicleListType = std::vector<AbstractVehicle*>;
+
+		/// Handle of a vehicle's registration with an intersection, i.e. the index of its slot in CrossingVehicles.
+		using RegistrationHandle = uint32_t;
+
+		/// Registration of a single vehicle with an intersection.
+		struct Registration
+		{
+			const AbstractVehicle* vehicle;				///< Registered vehicle, nullptr if the slot is free.
+			Intersection::CrossingVehicleInfo info;		///< Crossing info of the vehicle.
+		};
+
+		/// All vehicles registered with one connection of an intersection.
+		/// Slots keep their index for the whole lifetime of a registration so that vehicles can access 
+		/// their registration directly by its RegistrationHandle. Freed slots are reused by later registrations.
+		struct CrossingVehicles
+		{
+			/// Blocking time interval of a registration in the blocking index.
+			struct BlockingInterval
+			{
+				double begin;					///< Begin of the blocking time.
+				double end;						///< End of the blocking time.
+				double maxEnd;					///< Maximum end of this and all previous intervals in the index.
+				RegistrationHandle handle;		///< Handle of the registration.
+			};
+
+			std::vector<Registration> slots;				///< Registrations, indexed by RegistrationHandle.
+			std::vector<RegistrationHandle> freeSlots;		///< Indices of all free slots.
+			std::vector<BlockingInterval> blockingIndex;	///< All registrations sorted by the begin of their blocking time.
+			bool blockingIndexOutdated = false;				///< Flag whether the registrations changed since the last call to updateBlockingIndices().
+		};
+
+		/// Dynamic state of a single intersection.
+		struct IntersectionState
+		{
+			CrossingVehicles aCrossingVehicles;		///< All vehicles registered with the first network connection.
+			CrossingVehicles bCrossingVehicles;		///< All vehicles registered with the second network connection.
+		};
+
+
+		/// Creates a new empty TrafficState for the given network.
+		/// \param	network		Network to store the traffic state for.
+		explicit TrafficState(const Network& network);
+
+		/// Returns the network this traffic state belongs to.
+		const Network& getNetwork() const;
+
+		/// Adapts the per-connection and per-intersection data to the current network.
+		/// Needs to be called after connections or intersections were added to or removed from the network.
+		/// Also updates the landmarks if the network was modified.
+		void resize();
+
+		/// Removes all vehicles from all connections and intersections.
+		void clear();
+
+		/// Returns the store holding the dynamic state of all vehicles.
+		VehicleStore& getVehicleStore();
+		/// Returns the store holding the dynamic state of all vehicles.
+		const VehicleStore& getVehicleStore() const;
+
+		/// Returns the cache of shortest-path trees toward the destinations of the vehicles.
+		RouteTreeCache& getRouteTrees();
+		/// Returns the cache of shortest-path trees toward the destinations of the vehicles.
+		const RouteTreeCache& getRouteTrees() const;
+
+		/// Returns the landmarks used as heuristic by the route search.
+		Landmarks& getLandmarks();
+		/// Returns the landmarks used as heuristic by the route search.
+		const Landmarks& getLandmarks() const;
+
+		/// Returns the store of the routes shared between the vehicles.
+		RouteStore& getRouteStore();
+		/// Returns the store of the routes shared between the vehicles.
+		const RouteStore& getRouteStore() const;
+
+		/// Returns a counter that changes whenever the costs used by the route search may have changed,
+		/// i.e. whenever the network was modified and, unless the cost snapshot is enabled, whenever
+		/// vehicles were added to or removed from any connection.
+		size_t getCongestionRevision() const;
+
+
+		// ============================================================================================
+		// Cost snapshot
+
+		/// Returns whether the route search uses the snapshot of the connection costs instead of the live traffic.
+		bool isCostSnapshotEnabled() const;
+
+		/// Returns the simulation time in s after which the snapshot of the connection costs is refreshed, 0 if the route search uses the live traffic.
+		double getCostSnapshotInterval() const;
+		/// Sets the simulation time in s after which the snapshot of the connection costs is refreshed.
+		/// Takes a new snapshot right away, 0 lets the route search use the live traffic on the connections.
+		void setCostSnapshotInterval(double value);
+
+		/// Refreshes the snapshot of the connection costs if it is enabled and the refresh interval has passed.
+		/// \param	currentTime		Current simulation time.
+		void updateCostSnapshot(double currentTime);
+
+		/// Takes a new snapshot of the connection costs from the vehicles currently on the connections.
+		void refreshCostSnapshot();
+
+		/// Returns the arc length of \e connection plus the penalty for the vehicles on it, as used by the route search.
+		/// Reads the snapshot if it is enabled, which may happen concurrently to the simulation modifying the
+		/// vehicles on the connections, the live traffic otherwise.
+		double getCongestedArcLength(const Connection& connection) const;
+
+
+		// ============================================================================================
+		// Connection traffic
+
+		/// Returns the list of vehicles currently on \e connection, sorted by ascending arc position.
+		const VehicleListType& getVehicles(const Connection& connection) const;
+
+		/// Adds \e vehicle at the given arc position to \e connection.
+		void addVehicle(const Connection& connection, AbstractVehicle* vehicle, double arcPosition);
+		/// Removes \e vehicle from \e connection.
+		/// Searches from the end of the connection, where vehicles usually leave it.
+		void removeVehicle(const Connection& connection, AbstractVehicle* vehicle);
+
+		/// Determines the vehicle in front of each vehicle in the VehicleStore along its route and stores it
+		/// in VehicleStore::Columns::leaders. Vehicles on the same connection are found by a single pass
+		/// over its sorted list, only the foremost vehicle of each connection follows its route further.
+		/// \param	lookaheadDistance	Maximum arc length between the vehicle and the start of the connection holding its leader.
+		void updateLeaders(double lookaheadDistance);
+
+		/// Restores the order of the vehicles on all connections after their arc positions changed.
+		/// Must be called after moving vehicles and before any vehicle is added to or searched on a connection.
+		/// Vehicles seldom overtake each other, hence this is linear in the number of vehicles in practice.
+		void sortVehicles();
+
+		/// Returns the first vehicle to be found behind \e arcPosition on \e connection within \e searchDistance.
+		/// If \e searchDistance exceeds the length of the connection, the function will recursively check
+		/// all following connections.
+		VehicleDistance getVehicleBehind(const Connection& connection, double arcPosition, double searchDistance) const;
+
+		/// Returns the first vehicle to be found before \e arcPosition on \e connection within \e searchDistance.
+		/// If \e searchDistance exceeds the length of the connection, the function will recursively check
+		/// all previous connections.
+		VehicleDistance getVehicleBefore(const Connection& connection, double arcPosition, double searchDistance) const;
+
+
+		// ============================================================================================
+		// Intersection traffic
+
+		/// Returns the dynamic state of \e intersection.
+		const IntersectionState& getIntersectionState(const Intersection& intersection) const;
+
+		/// Registers \e vehicle with \e intersection and returns the handle of the registration.
+		/// \param  intersection		The intersection to register with.
+		/// \param  vehicle				The vehicle that is going to use the intersection
+		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining the intersection.
+		/// \param  remainingDistance	Remaining distance of the vehicle to the intersection (arc length).
+		/// \param  blockingTime		Simulation time interval this vehicle will block the intersection.
+		RegistrationHandle registerVehicle(const Intersection& intersection, const AbstractVehicle& vehicle, const Connection& connection, double remainingDistance, vec2 blockingTime);
+
+		/// Updates the crossing info of a registered vehicle.
+		/// \param  intersection		The intersection the vehicle is registered with.
+		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining the intersection.
+		/// \param  handle				Handle returned by registerVehicle().
+		/// \param  remainingDistance	Remaining distance of the vehicle to the intersection (arc length).
+		/// \param  blockingTime		Simulation time interval this vehicle will block the intersection.
+		void updateVehicle(const Intersection& intersection, const Connection& connection, RegistrationHandle handle, double remainingDistance, vec2 blockingTime);
+
+		/// Updates the waiting status how the given vehicle will interact with \e intersection.
+		/// The new status only becomes visible to other vehicles after calling publishVehicleWait().
+		/// \param  intersection		The intersection the vehicle is registered with.
+		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining the intersection.
+		/// \param  handle				Handle returned by registerVehicle().
+		/// \param  willWaitInFront		Flag whether the vehicle is going to wait in front of the intersection.
+		void updateVehicleWait(const Intersection& intersection, const Connection& connection, RegistrationHandle handle, bool willWaitInFront);
+
+		/// Publishes the waiting status set by updateVehicleWait() to other vehicles.
+		/// \param  intersection		The intersection the vehicle is registered with.
+		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining the intersection.
+		/// \param  handle				Handle returned by registerVehicle().
+		void publishVehicleWait(const Intersection& intersection, const Connection& connection, RegistrationHandle handle);
+
+		/// Unregisters a vehicle from \e intersection, \e handle becomes invalid afterwards.
+		/// \param  intersection		The intersection the vehicle is registered with.
+		/// \param  connection			The connection the vehicle used/planned to use. Must be one of the two connections defining the intersection.
+		/// \param  handle				Handle returned by registerVehicle().
+		void unregisterVehicle(const Intersection& intersection, const Connection& connection, RegistrationHandle handle);
+
+		/// Sorts the registrations of all intersections that changed by their blocking time.
+		/// Must be called after registering or updating vehicles and before calling forEachInterferingVehicle().
+		void updateBlockingIndices();
+
+		/// Calls \e func for all crossing entities at \e intersection that interfere with the given vehicle.
+		/// Only visits the registrations whose blocking time overlaps with the one of the given vehicle, 
+		/// using the blocking index built by the last call to updateBlockingIndices().
+		/// \param  intersection		The intersection the vehicle is registered with.
+		/// \param  connection			The connection the vehicle is going to use. Must be one of the two connections defining the intersection.
+		/// \param  handle				Handle returned by registerVehicle().
+		/// \param  func				Callable taking a const Intersection::CrossingVehicleInfo&, returns false to stop the iteration.
+		template<typename FuncT>
+		void forEachInterferingVehicle(const Intersection& intersection, const Connection& connection, RegistrationHandle handle, FuncT&& func) const;
+
+		/// Returns the crossing info of the registration \e handle with \e intersection.
+		const Intersection::CrossingVehicleInfo& getCrossingVehicleInfo(const Intersection& intersection, const Connection& connection, RegistrationHandle handle) const;
+
+	private:
+		/// Moves the vehicle list of each connection to its current Connection::getIndex(), which changes
+		/// for all following connections when a connection is removed. Lists of removed connections are dropped.
+		void remapConnections();
+
+		/// Returns the first vehicle on the connections following the current one on the route of \e vehicle.
+		/// \param	vehicle			Vehicle whose route to follow.
+		/// \param	arcPosition		Arc position of \e vehicle on its current connection.
+		/// \param	searchDistance	Maximum arc length to the start of the connection holding the found vehicle.
+		VehicleDistance getVehicleOnRoute(const AbstractVehicle& vehicle, double arcPosition, double searchDistance) const;
+
+		VehicleListType::const_iterator vehicleIteratorBehind(const VehicleListType& vehicles, double arcPosition) const;
+		VehicleListType::const_iterator vehicleIteratorBefore(const VehicleListType& vehicles, double arcPosition) const;
+
+		Registration& getRegistration(const Intersection& intersection, const Connection& connection, RegistrationHandle handle);
+
+		/// Checks whether vehicles on the two connections of \e intersection can interfere at all.
+		static bool canInterfere(const Intersection& intersection);
+
+		CrossingVehicles& getCrossingVehicles(const Intersection& intersection, const Connection& connection);
+		const CrossingVehicles& getCrossingVehicles(const Intersection& intersection, const Connection& connection) const;
+
+		const Network& m_network;							///< Network this traffic state belongs to.
+		std::vector<VehicleListType> m_connections;			///< Vehicles on each connection, indexed by Connection::getIndex().
+		std::vector<const Connection*> m_connectionKeys;	///< Connection each entry of m_connections belongs to.
+		std::vector<IntersectionState> m_intersections;		///< State of each intersection, indexed by Intersection::getIndex().
+		VehicleStore m_vehicleStore;						///< Dynamic state of all vehicles.
+		RouteTreeCache m_routeTrees;						///< Shortest-path trees computed from the congestion on the connections.
+		Landmarks m_landmarks;								///< Landmarks of the network used as heuristic by the route search.
+		RouteStore m_routeStore;							///< Routes shared between the vehicles.
+		size_t m_congestionRevision;						///< See getCongestionRevision().
+		size_t m_topologyRevision;							///< Topology revision of the network at the last call to resize().
+
+		std::vector<double> m_costSnapshot;					///< Congested arc length of each connection at the last snapshot, indexed by Connection::getIndex().
+		double m_costSnapshotInterval;						///< See getCostSnapshotInterval().
+		double m_lastCostSnapshotTime;						///< Simulation time of the last snapshot.
+	};
+
+
+	// ================================================================================================
+
+
+	template<typename FuncT>
+	void TrafficState::forEachInterferingVehicle(const Intersection& intersection, const Connection& connection, RegistrationHandle handle, FuncT&& func) const
+	{
+		if (!canInterfere(intersection))
+			return;
+
+		const auto& thisCvt = getCrossingVehicleInfo(intersection, connection, handle);
+		const auto& other = getCrossingVehicles(intersection, intersection.getOtherConnection(connection));
+		assert(!other.blockingIndexOutdated);
+
+		// skip all intervals ending before mine begins, stop at the first one beginning after mine ends
+		auto it = std::partition_point(other.blockingIndex.begin(), other.blockingIndex.end(), [&thisCvt](const CrossingVehicles::BlockingInterval& bi) {
+			return bi.maxEnd < thisCvt.blockingTime[0];
+		});
+		for (/**/; it != other.blockingIndex.end() && !(thisCvt.blockingTime[1] < it->begin); ++it)
+		{
+			const auto& otherCvt = other.slots[it->handle].info;
+			if ((!otherCvt.willWaitInFront || otherCvt.remainingDistance < 0)
+				&& !(thisCvt.blockingTime[0] > otherCvt.blockingTime[1] || thisCvt.blockingTime[1] < otherCvt.blockingTime[0])) // computes intersection of blocking time intervals
+			{
+				if (!func(otherCvt))
+					return;
+			}
+		}
+	}
+
+}
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef CTS_CORE_TRAFFICVOLUME_H__
+#define CTS_CORE_TRAFFICVOLUME_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+#include <cts-core/network/location.h>
+
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Node;
+
+	/// Vehicle classes distinguished by TrafficVolume.
+	enum class VehicleType
+	{
+		Car,
+		Truck,
+		Bus,
+		Tram,
+	};
+
+	/// Number of entries in VehicleType.
+	const size_t numVehicleTypes = 4;
+
+
+	/// Structure describing the traffic volume from a given location toward a given destination.
+	struct CTS_CORE_API TrafficVolume : public utils::NotCopyable
+	{
+		TrafficVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination);
+
+		/// Returns the traffic density for vehicles of the given type.
+		int getVehiclesPerHour(VehicleType type) const;
+
+		Location start;			///< Start nodes where vehicles are supposed to spawn.
+		Location destination;	///< Destination nodes of the spawned vehicles.
+		int carsPerHour;		///< Traffic density for cars.
+
+		// FIXME: do not have a fixed set of vehicle classes but use some cool tag system
+		int trucksPerHour;		///< Traffic density for trucks.
+		int busesPerHour;		///< Traffic density for buses.
+		int tramsPerHour;		///< Traffic density for trams.
+	};
+
+}
+}
+
+#endif
@@ -2,9 +2,15 @@
 #define CTS_CORE_VEHICLE_H__
 
 #include <cts-core/coreapi.h>
+#include <cts-core/base/math.h>
+#include <cts-core/base/ringbuffer.h>
 #include <cts-core/base/utils.h>
 #include <cts-core/network/routing.h>
+#include <cts-core/traffic/arrivaltimeprofile.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehiclestore.h>
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 
@@ -12,17 +18,23 @@ namespace cts { namespace core
 {
 	class Connection;
 	class Node;
+	class RoutePlanner;
 
 	/**
 	 * Abstract base class for all vehicles that move through the network.
 	 */
 	class CTS_CORE_API AbstractVehicle : public utils::NotCopyable
 	{
+		friend class RoutePlanner;
+
 	public:
+		/// Snapshot of the dynamic state of a vehicle.
+		using State = VehicleState;
+
 		int debugId;
 
-		AbstractVehicle(const Node& start, const std::vector<Node*> destination, double targetVelocity);
-		virtual ~AbstractVehicle() = default;
+		AbstractVehicle(TrafficState& trafficState, const Node& start, const std::vector<Node*> destination, double targetVelocity);
+		virtual ~AbstractVehicle();
 
 
 
@@ -32,21 +44,86 @@ namespace cts { namespace core
 		/// maximum velocity of the vehicle's current connection. 
 		double getEffectiveTargetVelocity() const;
 
+		/// Returns the traffic state this vehicle moves in.
+		const TrafficState& getTrafficState() const;
+
+		/// Returns the id of this vehicle's row in the VehicleStore of its traffic state.
+		VehicleId getVehicleId() const;
+
+		/// Returns the route this vehicle is planning to use, starting with its current connection.
+		const Routing& getRouting() const;
+
+		/// Returns the maximum distance to look for vehicles in front.
+		static double getLookaheadDistance();
+
+		/// Returns how often the number of intersections within the lookahead distance exceeded 
+		/// registrationWindowCapacity for this vehicle, each time forcing an allocation.
+		size_t getNumRegistrationOverflows() const;
+
+		/// Default value of getRouteRepairThreshold().
+		static const double defaultRouteRepairThreshold;
+
+		/// Returns the maximum relative change of the congestion-adjusted costs of the remaining route 
+		/// up to which the route is kept when moving on to the next connection.
+		double getRouteRepairThreshold() const;
+		/// Sets the maximum relative change of the congestion-adjusted costs of the remaining route up to
+		/// which the route is kept when moving on to the next connection, see Routing::computeCostChange().
+		/// A negative value computes a new route on every connection transition.
+		void setRouteRepairThreshold(double value);
+
+		/// Returns the planner computing new routes of this vehicle asynchronously, nullptr if they are computed right away.
+		RoutePlanner* getRoutePlanner() const;
+		/// Sets the planner computing new routes of this vehicle asynchronously, nullptr to compute them right away.
+		/// The vehicle then keeps following its remaining route until the planner delivers the new one.
+		/// Routes following the cached shortest-path trees are always computed right away.
+		void setRoutePlanner(RoutePlanner* value);
+
+		/// Returns how often a full route search was run for this vehicle, including the initial one.
+		size_t getNumRouteComputations() const;
+		/// Returns how often this vehicle kept its remaining route when moving on to the next connection.
+		size_t getNumRouteRepairs() const;
+
 		const Connection* getCurrentConnection() const;
 		void setCurrentConnection(const Connection* value);
 
 		double getCurrentArcPosition() const;
 		void setCurrentArcPosition(double value);
 
+		/// Returns the current velocity in m/s.
+		double getCurrentVelocity() const;
+
 		double getLength() const;
 
+		/// Returns the simulation time when this vehicle was spawned.
+		double getSpawnTime() const;
+		/// Sets the simulation time when this vehicle was spawned.
+		void setSpawnTime(double value);
+
+		/// Returns the arc length this vehicle has travelled so far in dm.
+		double getTravelledDistance() const;
+		/// Returns whether this vehicle has reached the end of its route.
+		bool hasArrived() const;
 
+		/// Returns the state of this vehicle as frozen by the last call to VehicleStore::freeze().
+		const State& getFrozenState() const;
+
+
+		/// Updates the intersection registrations for the next think phase.
+		/// Must not be called concurrently.
 		void prepare(double currentTime);
 
-		void think();
-		double think(const Routing& routing) const;
+		/// Computes the acceleration for the next move.
+		/// Only writes to this vehicle and its own intersection registrations, hence it is safe to call 
+		/// think() concurrently for different vehicles.
+		virtual void think() = 0;
 
-		void move(double tickLength);
+		/// Publishes the waiting decisions of the last think() call to the registered intersections so
+		/// that other vehicles will consider them during the next think phase.
+		void publishDecisions();
+
+		/// Moves this vehicle on to the next connection of its route, or marks it as arrived, after
+		/// VehicleStore::move() advanced it past the end of its current connection.
+		void leaveConnection();
 
 
 		/// Calculates the desired distance with respect to the given parameters.
@@ -67,6 +144,8 @@ namespace cts { namespace core
 		virtual double getAcceleration(double velocity, double desiredVelocity, double distance, double vDiff) const = 0;
 
 
+		/// Estimates the time in s this vehicle needs to cover \e distance (in dm) without any vehicle in front.
+		/// Not thread-safe, since the free-road trajectory is cached in the vehicle.
 		double computeArrivalTime(double distance) const;
 
 	protected:
@@ -74,29 +153,58 @@ namespace cts { namespace core
 		/// Takes care of registering/unregistering.
 		struct CTS_CORE_API SpecificIntersection : public utils::NotCopyable
 		{
-			SpecificIntersection(const AbstractVehicle* vehicle, Intersection* intersection, const Connection* connection);
+			SpecificIntersection(TrafficState& trafficState, const AbstractVehicle* vehicle, const Intersection* intersection, const Connection* connection, double remainingDistance, vec2 blockingTime);
+			/// Takes over the registration of \e other.
+			SpecificIntersection(SpecificIntersection&& other);
 			~SpecificIntersection();
 
 			void update(double remainingDistance, vec2 blockingTime) const;
 			void setWait(bool willWaitInFront) const;
+			void publishWait() const;
+			const Intersection::CrossingVehicleInfo& getCrossingVehicleInfo() const;
 
+			TrafficState* trafficState;					///< Traffic state holding the registration, nullptr if it was moved away.
 			const AbstractVehicle* vehicle;
-			Intersection* intersection;
+			const Intersection* intersection;
 			const Connection* connection;
+			TrafficState::RegistrationHandle handle;	///< Handle of the registration with the intersection.
 		};
 
-		struct AccelerationDistance
+		/// Obstacle in front of the vehicle that the driving model needs to react to.
+		struct Obstacle
 		{
 			bool considerable; //< FIXME: find a better name
-			double acceleration;
-			double distance;
+			double distance;	///< Distance to the obstacle.
+			double vDiff;		///< Velocity difference to the obstacle.
 		};
 
-		AccelerationDistance thinkOfVehiclesInFront(double lookaheadDistance) const;
+		/// Implements think() for the given driving model.
+		/// Templated on the driving model so that TypedVehicle can resolve all calls at compile time.
+		template<typename DrivingModelT>
+		double computeAcceleration(const DrivingModelT& drivingModel) const;
+
+		/// Implements think() for the given driving model with the acceleration for following the vehicle in front
+		/// already computed, e.g. by the batch kernel of the driving model.
+		/// \param	drivingModel			Driving model of the vehicle.
+		/// \param	vehicleInFront			Vehicle in front as returned by thinkOfVehiclesInFront().
+		/// \param	followingAcceleration	Acceleration of the driving model for following \e vehicleInFront.
+		template<typename DrivingModelT>
+		double computeAcceleration(const DrivingModelT& drivingModel, const Obstacle& vehicleInFront, double followingAcceleration) const;
 
-		AccelerationDistance thinkOfIntersection(double lookaheadDistance) const;
+		/// Sets the acceleration to be used for the next move.
+		void setAcceleration(double value);
+
+		/// Returns the vehicle in front as found by the last call to TrafficState::updateLeaders().
+		Obstacle thinkOfVehiclesInFront() const;
+
+		/// Updates the waiting decisions for all registered intersections.
+		/// Returns an obstacle that is not considerable if the vehicle does not need to wait in front of any of them.
+		/// \param	stopPoint		Distance where the vehicle will stop due to other constraints.
+		/// \param	minimumDistance	Minimum distance the driving model keeps to a standing vehicle.
+		Obstacle thinkOfIntersection(double stopPoint, double minimumDistance) const;
 
 		/// Computes the new routing for this vehicle and updates all internal (e.g. registered intersections) data accordingly.
+		/// Follows the cached shortest-path tree toward the destination nodes if the RouteTreeCache of the traffic state is enabled.
 		/// \param  startNode			Start node
 		/// \param  destinationNodes	Destination nodes
 		void updateRouting(const Node& startNode, std::vector<Node*> destinationNodes);
@@ -104,22 +212,35 @@ namespace cts { namespace core
 		double computeDistance(const Connection& connection, double arcPos) const;
 	
 		static const double m_lookaheadDistance;
+		/// Number of intersections within the lookahead distance a vehicle can register with without allocating.
+		static const size_t registrationWindowCapacity;
+
+		TrafficState& m_trafficState;			///< Traffic state this vehicle moves in.
+		VehicleId m_id;							///< Id of this vehicle's row in the VehicleStore holding its dynamic state.
 
-		double m_targetVelocity;
 		double m_multiplierTargetVelocity;
-		double m_acceleration;
-		double m_velocity;
 
 		const Connection* m_currentConnection;
 		std::vector<Node*> m_destinationNodes;
-		double m_currentArcPosition;
 		double m_length;
 
+		double m_spawnTime;						///< Simulation time when this vehicle was spawned.
+		bool m_arrived;							///< Flag whether this vehicle has reached the end of its route.
+
 	private:
+		/// Replaces the route after the current connection by the route computed by the RoutePlanner.
+		void continueRouting(const Routing& continuation);
+
 		Routing m_routing;						///< Route that the vehicle is planning to use, includes current connection
-		std::list<SpecificIntersection> m_registeredIntersections;
+		mutable ArrivalTimeProfile m_arrivalTimeProfile;	///< Cached free-road trajectory for computeArrivalTime().
+		RingBuffer<SpecificIntersection> m_registeredIntersections;	///< Intersections within the lookahead distance, sorted along the route.
 		std::vector<const Connection*> m_visitedConnections;
 
+		double m_routeRepairThreshold;			///< See getRouteRepairThreshold().
+		RoutePlanner* m_routePlanner;			///< See getRoutePlanner().
+		size_t m_numRouteComputations;			///< Number of full route searches so far.
+		size_t m_numRouteRepairs;				///< Number of connection transitions that kept the remaining route.
+
 	};
 
 
@@ -129,6 +250,9 @@ namespace cts { namespace core
 	class CTS_CORE_API IdmMobil
 	{
 	public:
+		/// Maximum relative deviation of getAccelerations() from getAcceleration().
+		static const double batchTolerance;
+
 		IdmMobil();
 
 		double getDesiredDistance(double velocity, double vDiff) const;
@@ -137,6 +261,13 @@ namespace cts { namespace core
 
 		double getAcceleration(double velocity, double desiredVelocity, double distance, double vDiff) const;
 
+		/// Calculates the accelerations of \e count vehicles at once, element i equals
+		/// getAcceleration(velocities[i], desiredVelocities[i], distances[i], vDiffs[i]) up to batchTolerance.
+		/// Pass an infinite distance for vehicles without a vehicle in front to get the free-road acceleration.
+		/// Processes four vehicles per instruction if cts-core was built with AVX2 support (ENABLE_AVX2),
+		/// the remaining ones are computed one by one. Used by VehicleBatch during the think phase.
+		void getAccelerations(size_t count, const double* velocities, const double* desiredVelocities, const double* distances, const double* vDiffs, double* accelerations) const;
+
 
 	protected:
 		double m_safetyDistanceTime;
@@ -150,13 +281,19 @@ namespace cts { namespace core
 	};
 
 
+	template<typename DrivingModelT>
+	class VehicleBatch;
+
+
 	template<typename DrivingModelT>
 	class TypedVehicle final : public AbstractVehicle
 	{
+		friend class VehicleBatch<DrivingModelT>;
+
 	public:
 		using DrivingModel = DrivingModelT;
 
-		TypedVehicle(const Node& start, const std::vector<Node*> destination, double targetVelocity);
+		TypedVehicle(TrafficState& trafficState, const Node& start, const std::vector<Node*> destination, double targetVelocity);
 		virtual ~TypedVehicle() = default;
 
 
@@ -177,7 +314,20 @@ namespace cts { namespace core
 			return m_drivingModel.getAcceleration(velocity, desiredVelocity, distance, vDiff);
 		}
 
+
+		virtual void think() override
+		{
+			setAcceleration(computeAcceleration(m_drivingModel));
+		}
+
 	protected:
+		/// Implements think() with the acceleration for following \e vehicleInFront computed by VehicleBatch
+		/// for all vehicles of the batch at once.
+		void think(const Obstacle& vehicleInFront, double followingAcceleration)
+		{
+			setAcceleration(computeAcceleration(m_drivingModel, vehicleInFront, followingAcceleration));
+		}
+
 		DrivingModel m_drivingModel;
 	};
 
@@ -186,8 +336,36 @@ namespace cts { namespace core
 
 
 	template<typename DrivingModelT>
-	TypedVehicle<DrivingModelT>::TypedVehicle(const Node& start, const std::vector<Node*> destination, double targetVelocity)
-		: AbstractVehicle(start, destination, targetVelocity)
+	double AbstractVehicle::computeAcceleration(const DrivingModelT& drivingModel) const
+	{
+		if (m_routing.getSegments().empty())
+			return 0.0;
+
+		const Obstacle vehicleInFront = thinkOfVehiclesInFront();
+		const double acceleration = drivingModel.getAcceleration(getCurrentVelocity(), getEffectiveTargetVelocity(), vehicleInFront.distance, vehicleInFront.vDiff);
+		return computeAcceleration(drivingModel, vehicleInFront, acceleration);
+	}
+
+
+	template<typename DrivingModelT>
+	double AbstractVehicle::computeAcceleration(const DrivingModelT& drivingModel, const Obstacle& vehicleInFront, double followingAcceleration) const
+	{
+		if (m_routing.getSegments().empty())
+			return 0.0;
+
+		Obstacle intersection = thinkOfIntersection(vehicleInFront.considerable ? vehicleInFront.distance : 0.0, drivingModel.getDesiredDistance(0, 0));
+		if (!intersection.considerable)
+			return followingAcceleration;
+		return std::min(followingAcceleration, drivingModel.getAcceleration(getCurrentVelocity(), getEffectiveTargetVelocity(), intersection.distance, intersection.vDiff));
+	}
+
+
+	// ================================================================================================
+
+
+	template<typename DrivingModelT>
+	TypedVehicle<DrivingModelT>::TypedVehicle(TrafficState& trafficState, const Node& start, const std::vector<Node*> destination, double targetVelocity)
+		: AbstractVehicle(trafficState, start, destination, targetVelocity)
 	{
 
 	}
@@ -0,0 +1,156 @@
+#ifndef CTS_CORE_VEHICLEBATCH_H__
+#define CTS_CORE_VEHICLEBATCH_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+#include <cts-core/traffic/vehicle.h>
+
+#include <memory>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class Node;
+	class TrafficState;
+
+	/**
+	 * Homogeneous batch of vehicles sharing the same driving model.
+	 *
+	 * TrafficManager keeps one batch per vehicle type. Only calling into a batch is dispatched at
+	 * runtime, the loops over the vehicles of a batch are instantiated for each driving model so that
+	 * all calls of the driving model are resolved at compile time. The accelerations for following the
+	 * vehicle in front are computed for all vehicles of a batch at once by the batch kernel of the
+	 * driving model.
+	 */
+	class CTS_CORE_API AbstractVehicleBatch : public utils::NotCopyable
+	{
+	public:
+		virtual ~AbstractVehicleBatch() = default;
+
+		/// Returns the number of vehicles in this batch.
+		virtual size_t size() const = 0;
+
+		/// Creates a new vehicle and adds it to this batch. The batch does not take ownership.
+		/// \param	trafficState	Traffic state the vehicle moves in.
+		/// \param	start			Start node of the vehicle.
+		/// \param	destination		Destination nodes of the vehicle.
+		virtual std::unique_ptr<AbstractVehicle> createVehicle(TrafficState& trafficState, const Node& start, const std::vector<Node*>& destination) = 0;
+
+		/// Removes all vehicles from this batch that are not on any connection anymore.
+		virtual void removeArrivedVehicles() = 0;
+
+		/// Removes all vehicles from this batch.
+		virtual void clear() = 0;
+
+		/// Calls think() for the vehicles with index in [begin, end).
+		virtual void think(size_t begin, size_t end) = 0;
+	};
+
+
+	/// AbstractVehicleBatch for vehicles of type TypedVehicle<DrivingModelT>.
+	/// DrivingModelT must provide a batch kernel like IdmMobil::getAccelerations(). All vehicles use
+	/// default-constructed driving models, hence the batch kernel of a single instance serves all of them.
+	template<typename DrivingModelT>
+	class VehicleBatch final : public AbstractVehicleBatch
+	{
+	public:
+		using Vehicle = TypedVehicle<DrivingModelT>;
+
+		/// Creates a new empty batch.
+		/// \param	targetVelocity	Target velocity of the created vehicles in m/s.
+		explicit VehicleBatch(double targetVelocity)
+			: m_targetVelocity(targetVelocity)
+		{}
+
+
+		virtual size_t size() const override
+		{
+			return m_vehicles.size();
+		}
+
+
+		virtual std::unique_ptr<AbstractVehicle> createVehicle(TrafficState& trafficState, const Node& start, const std::vector<Node*>& destination) override
+		{
+			auto vehicle = std::make_unique<Vehicle>(trafficState, start, destination, m_targetVelocity);
+			m_vehicles.push_back(vehicle.get());
+			resizeThinkBuffers();
+			return vehicle;
+		}
+
+
+		virtual void removeArrivedVehicles() override
+		{
+			utils::remove_erase_if(m_vehicles, [](const Vehicle* v) { return v->getCurrentConnection() == nullptr; });
+			resizeThinkBuffers();
+		}
+
+
+		virtual void clear() override
+		{
+			m_vehicles.clear();
+			resizeThinkBuffers();
+		}
+
+
+		virtual void think(size_t begin, size_t end) override
+		{
+			// Gather the input of the driving model for following the vehicle in front so that the batch kernel
+			// computes these accelerations at once. Vehicle is final, hence all other calls are resolved statically.
+			for (size_t i = begin; i < end; ++i)
+			{
+				const Vehicle& v = *m_vehicles[i];
+				if (v.getRouting().getSegments().empty())
+				{
+					// vehicles without a route do not accelerate at all
+					m_vehiclesInFront[i] = Obstacle{ false, AbstractVehicle::getLookaheadDistance(), 0.0 };
+					m_velocities[i] = 0.0;
+					m_targetVelocities[i] = 1.0;
+				}
+				else
+				{
+					m_vehiclesInFront[i] = v.thinkOfVehiclesInFront();
+					m_velocities[i] = v.getCurrentVelocity();
+					m_targetVelocities[i] = v.getEffectiveTargetVelocity();
+				}
+				m_distances[i] = m_vehiclesInFront[i].distance;
+				m_vDiffs[i] = m_vehiclesInFront[i].vDiff;
+			}
+
+			m_drivingModel.getAccelerations(end - begin, m_velocities.data() + begin, m_targetVelocities.data() + begin, m_distances.data() + begin, m_vDiffs.data() + begin, m_accelerations.data() + begin);
+
+			for (size_t i = begin; i < end; ++i)
+				m_vehicles[i]->think(m_vehiclesInFront[i], m_accelerations[i]);
+		}
+
+	private:
+		using Obstacle = typename Vehicle::Obstacle;
+
+		/// Adapts the size of the buffers used by think() to the number of vehicles.
+		/// The buffers are indexed like m_vehicles, hence think() may run concurrently on disjoint ranges.
+		void resizeThinkBuffers()
+		{
+			const size_t n = m_vehicles.size();
+			m_vehiclesInFront.resize(n);
+			m_velocities.resize(n);
+			m_targetVelocities.resize(n);
+			m_distances.resize(n);
+			m_vDiffs.resize(n);
+			m_accelerations.resize(n);
+		}
+
+		double m_targetVelocity;				///< Target velocity of the created vehicles in m/s.
+		std::vector<Vehicle*> m_vehicles;		///< Vehicles of this batch, owned by the TrafficManager.
+		DrivingModelT m_drivingModel;			///< Driving model whose batch kernel computes the accelerations of all vehicles.
+
+		std::vector<Obstacle> m_vehiclesInFront;	///< Vehicle in front of each vehicle during think().
+		std::vector<double> m_velocities;			///< Velocity of each vehicle during think().
+		std::vector<double> m_targetVelocities;		///< Effective target velocity of each vehicle during think().
+		std::vector<double> m_distances;			///< Distance to the vehicle in front of each vehicle during think().
+		std::vector<double> m_vDiffs;				///< Velocity difference to the vehicle in front of each vehicle during think().
+		std::vector<double> m_accelerations;		///< Acceleration for following the vehicle in front of each vehicle during think().
+	};
+
+}
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef CTS_CORE_VEHICLESTORE_H__
+#define CTS_CORE_VEHICLESTORE_H__
+
+#include <cts-core/coreapi.h>
+#include <cts-core/base/utils.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace cts { namespace core
+{
+	class AbstractVehicle;
+
+	/// Stable identifier of a vehicle within a VehicleStore.
+	using VehicleId = uint32_t;
+
+
+	/// Snapshot of the dynamic state of a vehicle.
+	/// During the think phase, vehicles only read the frozen state of other vehicles so that all
+	/// vehicles can think concurrently without depending on the order of evaluation.
+	struct VehicleState
+	{
+		double arcPosition;		///< Arc position on the current connection.
+		double velocity;		///< Velocity in m/s.
+		double acceleration;	///< Acceleration computed during the last think phase.
+	};
+
+
+	/**
+	 * Struct-of-arrays storage for the hot per-vehicle data of a TrafficState.
+	 *
+	 * The data touched by every vehicle in every tick is stored in contiguous arrays so that the tick
+	 * kernels (freeze() and move()) stream linearly through memory. Rarely used data such as the route
+	 * or the registered intersections stays in the AbstractVehicle, which is referenced from here.
+	 *
+	 * Rows are kept in insertion order and are addressed by a dense index, which changes when removed
+	 * rows are erased by compact(). Vehicles therefore refer to their row by a VehicleId, which stays
+	 * valid until the vehicle is removed.
+	 */
+	class CTS_CORE_API VehicleStore : public utils::NotCopyable
+	{
+	public:
+		/// Connection index of vehicles that are not on any connection.
+		static const uint32_t noConnection = std::numeric_limits<uint32_t>::max();
+
+		/// Hot per-vehicle data, all arrays are indexed by the dense vehicle index.
+		struct Columns
+		{
+			std::vector<double> arcPositions;			///< Arc position on the current connection.
+			std::vector<double> velocities;				///< Velocity in m/s.
+			std::vector<double> accelerations;			///< Acceleration computed during the last think phase.
+			std::vector<double> targetVelocities;		///< Target velocity of the vehicle if it was free from any outer constraints.
+			std::vector<double> travelledDistances;		///< Arc length travelled so far in dm.
+			std::vector<uint32_t> connectionIndices;	///< Connection::getIndex() of the current connection or noConnection.
+			std::vector<double> connectionLengths;		///< Arc length of the current connection.
+			std::vector<VehicleState> frozenStates;		///< State as frozen by the last call to freeze().
+			std::vector<AbstractVehicle*> leaders;		///< Vehicle in front along the route as found by TrafficState::updateLeaders(), nullptr if none.
+			std::vector<double> leaderDistances;		///< Arc length to the front of the leader.
+		};
+
+
+		/// Adds a new row for \e vehicle and returns its id.
+		/// \param	vehicle			The vehicle owning the row.
+		/// \param	velocity		Initial velocity in m/s.
+		/// \param	targetVelocity	Target velocity in m/s.
+		VehicleId add(AbstractVehicle* vehicle, double velocity, double targetVelocity);
+
+		/// Marks the row of the vehicle with the given id as removed.
+		/// The row is kept until the next call to compact(), in the meantime getVehicle() returns nullptr
+		/// for it and move() skips it.
+		void remove(VehicleId id);
+
+		/// Erases all removed rows in a single pass while keeping the order of all other rows.
+		/// Must be called before iterating over the rows again after vehicles were removed.
+		void compact();
+
+		/// Returns the number of rows in this store, including removed rows not yet erased by compact().
+		size_t size() const;
+
+		/// Returns the current dense index of the vehicle with the given id.
+		size_t getIndex(VehicleId id) const
+		{
+			return m_indices[id];
+		}
+
+		/// Returns the vehicle stored at the given dense index.
+		AbstractVehicle* getVehicle(size_t index) const;
+
+		/// Returns the hot per-vehicle data.
+		Columns& getColumns();
+		/// Returns the hot per-vehicle data.
+		const Columns& getColumns() const;
+
+
+		/// Copies the current state of all vehicles into their frozen state.
+		void freeze();
+
+		/// Advances all vehicles on a connection according to their velocity and acceleration.
+		/// The arc positions of vehicles leaving their current connection are not wrapped, their
+		/// indices are appended to \e leavingVehicles in ascending order instead.
+		/// \param	tickLength		Duration of the tick in seconds.
+		/// \param	leavingVehicles	Dense indices of the vehicles that passed the end of their connection.
+		void move(double tickLength, std::vector<size_t>& leavingVehicles);
+
+	private:
+		Columns m_columns;							///< Hot per-vehicle data.
+		std::vector<AbstractVehicle*> m_vehicles;	///< Vehicle of each row, keeps the cold per-vehicle data.
+		std::vector<VehicleId> m_ids;				///< Id of each row.
+
+		std::vector<uint32_t> m_indices;			///< Dense index of each id.
+		std::vector<VehicleId> m_freeIds;			///< Ids of removed vehicles to be reused.
+		std::vector<VehicleId> m_removedIds;		///< Ids of the removed rows not yet erased by compact().
+	};
+
+}
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <cts-core/base/spatialgrid.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace cts { namespace core
+{
+
+	namespace
+	{
+		bool isEmpty(const Bounds2& bounds)
+		{
+			// use negated version to correctly detect NaN
+			return !(bounds.getLlf()[0] <= bounds.getUrb()[0] && bounds.getLlf()[1] <= bounds.getUrb()[1]);
+		}
+	}
+
+
+	SpatialGrid::SpatialGrid(std::vector<Bounds2> bounds)
+		: m_bounds(std::move(bounds))
+		, m_cellSize(1.0)
+		, m_numCellsX(0)
+		, m_numCellsY(0)
+	{
+		assert(m_bounds.size() < std::numeric_limits<uint32_t>::max());
+
+		size_t numBounds = 0;
+		double totalExtent = 0.0;
+		for (auto& b : m_bounds)
+		{
+			if (isEmpty(b))
+				continue;
+
+			m_gridBounds.addPoint(b.getLlf());
+			m_gridBounds.addPoint(b.getUrb());
+			const vec2 diagonal = b.getUrb() - b.getLlf();
+			totalExtent += std::max(diagonal[0], diagonal[1]);
+			++numBounds;
+		}
+		if (numBounds == 0)
+			return;
+
+		// Cells should be at least as large as the average box, so that boxes are registered with only a few
+		// cells. At the same time, there should not be considerably more cells than boxes.
+		const vec2 gridDiagonal = m_gridBounds.getUrb() - m_gridBounds.getLlf();
+		m_cellSize = std::max({ totalExtent / numBounds, std::sqrt(gridDiagonal[0] * gridDiagonal[1] / numBounds), std::max(gridDiagonal[0], gridDiagonal[1]) / numBounds });
+		if (!(m_cellSize > 0.0))
+			m_cellSize = 1.0;
+		m_numCellsX = size_t(gridDiagonal[0] / m_cellSize) + 1;
+		m_numCellsY = size_t(gridDiagonal[1] / m_cellSize) + 1;
+
+		// counting sort of the boxes into the cells, each cell lists its boxes in ascending order
+		m_cellStarts.assign(m_numCellsX * m_numCellsY + 1, 0);
+		for (auto& b : m_bounds)
+		{
+			if (isEmpty(b))
+				continue;
+
+			const auto xRange = getCellRange(b, 0);
+			const auto yRange = getCellRange(b, 1);
+			for (size_t y = yRange.first; y <= yRange.second; ++y)
+			{
+				for (size_t x = xRange.first; x <= xRange.second; ++x)
+					++m_cellStarts[y * m_numCellsX + x + 1];
+			}
+		}
+		for (size_t i = 1; i < m_cellStarts.size(); ++i)
+			m_cellStarts[i] += m_cellStarts[i - 1];
+
+		std::vector<uint32_t> cellEnds(m_cellStarts.begin(), m_cellStarts.end() - 1);
+		m_cellItems.resize(m_cellStarts.back());
+		for (size_t i = 0; i < m_bounds.size(); ++i)
+		{
+			if (isEmpty(m_bounds[i]))
+				continue;
+
+			const auto xRange = getCellRange(m_bounds[i], 0);
+			const auto yRange = getCellRange(m_bounds[i], 1);
+			for (size_t y = yRange.first; y <= yRange.second; ++y)
+			{
+				for (size_t x = xRange.first; x <= xRange.second; ++x)
+					m_cellItems[cellEnds[y * m_numCellsX + x]++] = uint32_t(i);
+			}
+		}
+	}
+
+
+	std::pair<size_t, size_t> SpatialGrid::getNumCells() const
+	{
+		return std::make_pair(m_numCellsX, m_numCellsY);
+	}
+
+
+	void SpatialGrid::query(const Bounds2& bounds, std::vector<size_t>& output) const
+	{
+		output.clear();
+		if (m_numCellsX == 0 || !m_gridBounds.intersects(bounds))
+			return;
+
+		const auto xRange = getCellRange(bounds, 0);
+		const auto yRange = getCellRange(bounds, 1);
+		for (size_t y = yRange.first; y <= yRange.second; ++y)
+		{
+			for (size_t x = xRange.first; x <= xRange.second; ++x)
+			{
+				const size_t cell = y * m_numCellsX + x;
+				for (uint32_t i = m_cellStarts[cell]; i < m_cellStarts[cell + 1]; ++i)
+				{
+					if (m_bounds[m_cellItems[i]].intersects(bounds))
+						output.push_back(m_cellItems[i]);
+				}
+			}
+		}
+
+		// boxes overlapping several cells were found several times
+		std::sort(output.begin(), output.end());
+		output.erase(std::unique(output.begin(), output.end()), output.end());
+	}
+
+
+	std::pair<size_t, size_t> SpatialGrid::getCellRange(const Bounds2& bounds, int axis) const
+	{
+		// The mapping to cells is monotonic, hence boxes overlapping each other always share a cell.
+		const size_t numCells = (axis == 0) ? m_numCellsX : m_numCellsY;
+		auto toCell = [this, axis, numCells](double coordinate) {
+			const double cell = std::floor((coordinate - m_gridBounds.getLlf()[axis]) / m_cellSize);
+			return size_t(math::clamp(cell, 0.0, double(numCells - 1)));
+		};
+		return std::make_pair(toCell(bounds.getLlf()[axis]), toCell(bounds.getUrb()[axis]));
+	}
+
+}
+}
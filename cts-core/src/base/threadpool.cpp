@@ -0,0 +1,135 @@
+#include <cts-core/base/threadpool.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace cts { namespace core
+{
+
+	ThreadPool::ThreadPool(size_t numThreads /*= 0*/)
+		: m_stop(false)
+	{
+		if (numThreads == 0)
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		// the calling thread participates in parallelFor(), hence we need one worker less.
+		m_workers.reserve(numThreads - 1);
+		for (size_t i = 1; i < numThreads; ++i)
+		{
+			m_workers.emplace_back([this]() { workerLoop(); });
+		}
+	}
+
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_condition.notify_all();
+
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+
+	size_t ThreadPool::getNumThreads() const
+	{
+		return m_workers.size() + 1;
+	}
+
+
+	void ThreadPool::enqueue(std::function<void()> task)
+	{
+		if (m_workers.empty())
+		{
+			task();
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.push_back(std::move(task));
+		}
+		m_condition.notify_one();
+	}
+
+
+	void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& func)
+	{
+		if (count == 0)
+			return;
+
+		// Use a few more chunks than threads so that uneven workloads are balanced out a little.
+		const size_t numChunks = std::min(count, getNumThreads() * 4);
+		if (numChunks <= 1 || m_workers.empty())
+		{
+			func(0, count);
+			return;
+		}
+
+		struct SharedState
+		{
+			std::atomic<size_t> nextChunk;
+			size_t pendingHelpers;
+			std::mutex mutex;
+			std::condition_variable done;
+		};
+
+		SharedState state;
+		state.nextChunk = 0;
+		state.pendingHelpers = std::min(m_workers.size(), numChunks - 1);
+
+		const size_t chunkSize = count / numChunks;
+		const size_t remainder = count % numChunks;
+		auto processChunks = [&]() {
+			for (size_t chunk = state.nextChunk++; chunk < numChunks; chunk = state.nextChunk++)
+			{
+				// the first remainder chunks get one additional element
+				const size_t begin = chunk * chunkSize + std::min(chunk, remainder);
+				const size_t end = begin + chunkSize + (chunk < remainder ? 1 : 0);
+				func(begin, end);
+			}
+		};
+
+		const size_t numHelpers = state.pendingHelpers;
+		for (size_t i = 0; i < numHelpers; ++i)
+		{
+			enqueue([&]() {
+				processChunks();
+				std::lock_guard<std::mutex> lock(state.mutex);
+				if (--state.pendingHelpers == 0)
+					state.done.notify_one();
+			});
+		}
+
+		processChunks();
+
+		std::unique_lock<std::mutex> lock(state.mutex);
+		state.done.wait(lock, [&state]() { return state.pendingHelpers == 0; });
+	}
+
+
+	void ThreadPool::workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+				if (m_stop && m_tasks.empty())
+					return;
+
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+}
+}
@@ -139,12 +139,12 @@ namespace core
 	}
 
 
-	void BezierParameterization::subdivide() const
+	void BezierParameterization::subdivide(const std::array<vec2, 4>& supportPoints, std::array<vec2, 4>& first, std::array<vec2, 4>& second)
 	{
 		// First Iteration
-		const vec2 p01 = m_supportPoints[0] + ((m_supportPoints[1] - m_supportPoints[0]) * 0.5);
-		const vec2 p11 = m_supportPoints[1] + ((m_supportPoints[2] - m_supportPoints[1]) * 0.5);
-		const vec2 p21 = m_supportPoints[2] + ((m_supportPoints[3] - m_supportPoints[2]) * 0.5);
+		const vec2 p01 = supportPoints[0] + ((supportPoints[1] - supportPoints[0]) * 0.5);
+		const vec2 p11 = supportPoints[1] + ((supportPoints[2] - supportPoints[1]) * 0.5);
+		const vec2 p21 = supportPoints[2] + ((supportPoints[3] - supportPoints[2]) * 0.5);
 
 		// Second Iteration:
 		const vec2 p02 = p01 + ((p11 - p01) * 0.5);
@@ -153,8 +153,18 @@ namespace core
 		// Third Iteration:
 		const vec2 p03 = p02 + ((p12 - p02) * 0.5);
 
-		m_subdividedFirst = std::make_unique<BezierParameterization>(m_supportPoints[0], p01, p02, p03);
-		m_subdividedSecond = std::make_unique<BezierParameterization>(p03, p12, p21, m_supportPoints[3]);
+		first = { { supportPoints[0], p01, p02, p03 } };
+		second = { { p03, p12, p21, supportPoints[3] } };
+	}
+
+
+	void BezierParameterization::subdivide() const
+	{
+		std::array<vec2, 4> first;
+		std::array<vec2, 4> second;
+		subdivide(m_supportPoints, first, second);
+		m_subdividedFirst = std::make_unique<BezierParameterization>(first[0], first[1], first[2], first[3]);
+		m_subdividedSecond = std::make_unique<BezierParameterization>(second[0], second[1], second[2], second[3]);
 	}
 
 }
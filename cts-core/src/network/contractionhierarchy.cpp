@@ -0,0 +1,384 @@
+#include <cts-core/network/contractionhierarchy.h>
+#include <cts-core/base/bounds.h>
+#include <cts-core/network/connection.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+#include <cts-core/network/routing.h>
+#include <cts-core/network/shortestpaths.h>
+#include <cts-core/traffic/trafficstate.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace cts { namespace core
+{
+
+	namespace
+	{
+		/// Search state of a single node during one direction of ContractionHierarchy::query().
+		struct SearchEntry
+		{
+			double costs;		///< Costs from the start node, respectively to the closest destination node.
+			uint32_t parent;	///< Previous node of the search, i.e. the next node on the path for the backward search.
+		};
+
+		/// Returns the costs of the node with the given index, infinite if it was not visited by the search.
+		double getCosts(const NodeScratch<SearchEntry>& entries, uint32_t index)
+		{
+			const SearchEntry* entry = entries.find(index);
+			return (entry != nullptr) ? entry->costs : std::numeric_limits<double>::infinity();
+		}
+
+		/// Per-thread scratch buffers of ContractionHierarchy::query().
+		struct QueryScratch
+		{
+			void reset(size_t numNodes)
+			{
+				forward.reset(numNodes);
+				backward.reset(numNodes);
+				openList.clear();
+			}
+
+			NodeScratch<SearchEntry> forward;		///< Search state of each node during the forward search.
+			NodeScratch<SearchEntry> backward;		///< Search state of each node during the backward search.
+			OpenList openList;						///< Open list of both searches, one after another.
+			std::vector<uint32_t> nodes;			///< Nodes of the path in the hierarchy.
+		};
+
+
+		/// Appends the given nodes to \e order by recursive geometric bisection, so that the nodes separating
+		/// both halves are ranked above all nodes of either half. Nodes within small cells keep their order.
+		/// \param	nodes		Network nodes
+		/// \param	neighbors	Undirected neighbors of each node, indexed by Node::getIndex().
+		/// \param	cell		Indices of the nodes to order.
+		/// \param	cellIds		Cell of each node, used to find the neighbors in the other half of a cell.
+		/// \param	numCells	Number of cell ids used so far.
+		/// \param	order		Receives the node indices by ascending rank.
+		void computeNestedDissection(const Network::NodeListType& nodes, const std::vector< std::vector<uint32_t> >& neighbors, std::vector<uint32_t> cell, std::vector<uint32_t>& cellIds, uint32_t& numCells, std::vector<uint32_t>& order)
+		{
+			static const size_t minCellSize = 16;
+			if (cell.size() <= minCellSize)
+			{
+				order.insert(order.end(), cell.begin(), cell.end());
+				return;
+			}
+
+			// split at the median position along the longer extent of the cell
+			Bounds2 bounds(nodes[cell.front()]->getPosition());
+			for (uint32_t node : cell)
+				bounds.addPoint(nodes[node]->getPosition());
+			const vec2 size = bounds.getUrb() - bounds.getLlf();
+			const int axis = (size[0] >= size[1]) ? 0 : 1;
+			const auto middle = cell.begin() + cell.size() / 2;
+			std::nth_element(cell.begin(), middle, cell.end(), [&nodes, axis](uint32_t lhs, uint32_t rhs) {
+				const double l = nodes[lhs]->getPosition()[axis];
+				const double r = nodes[rhs]->getPosition()[axis];
+				return l < r || (l == r && lhs < rhs);
+			});
+
+			const uint32_t firstId = numCells++;
+			const uint32_t secondId = numCells++;
+			for (auto it = cell.begin(); it != middle; ++it)
+				cellIds[*it] = firstId;
+			for (auto it = middle; it != cell.end(); ++it)
+				cellIds[*it] = secondId;
+
+			// nodes of the first half adjacent to the second one form the separator
+			std::vector<uint32_t> first, second(middle, cell.end()), separator;
+			for (auto it = cell.begin(); it != middle; ++it)
+			{
+				const auto& n = neighbors[*it];
+				const bool isSeparator = std::any_of(n.begin(), n.end(), [&cellIds, secondId](uint32_t neighbor) { return cellIds[neighbor] == secondId; });
+				(isSeparator ? separator : first).push_back(*it);
+			}
+			cell.clear();
+			cell.shrink_to_fit();
+
+			computeNestedDissection(nodes, neighbors, std::move(first), cellIds, numCells, order);
+			computeNestedDissection(nodes, neighbors, std::move(second), cellIds, numCells, order);
+			order.insert(order.end(), separator.begin(), separator.end());
+		}
+	}
+
+
+	const uint32_t ContractionHierarchy::noNode = std::numeric_limits<uint32_t>::max();
+
+
+	ContractionHierarchy::ContractionHierarchy(const Network& network)
+		: m_network(network)
+		, m_topologyRevision(network.getTopologyRevision())
+	{
+		const auto& nodes = network.getNodes();
+		const size_t numNodes = nodes.size();
+
+		// undirected neighbors of each node that has not been contracted yet, sorted by index
+		std::vector< std::vector<uint32_t> > neighbors(numNodes);
+		auto addNeighbor = [&neighbors](uint32_t node, uint32_t neighbor) {
+			auto& list = neighbors[node];
+			auto it = std::lower_bound(list.begin(), list.end(), neighbor);
+			if (it == list.end() || *it != neighbor)
+				list.insert(it, neighbor);
+		};
+		for (const Connection& connection : network.getConnections())
+		{
+			const uint32_t start = uint32_t(connection.getStartNode().getIndex());
+			const uint32_t end = uint32_t(connection.getEndNode().getIndex());
+			if (start == end)
+				continue;
+			addNeighbor(start, end);
+			addNeighbor(end, start);
+		}
+
+		// Contract the nodes in nested dissection order, connecting all remaining neighbors of each
+		// contracted node by shortcuts.
+		std::vector<uint32_t> cell(numNodes);
+		for (uint32_t i = 0; i < numNodes; ++i)
+			cell[i] = i;
+		std::vector<uint32_t> cellIds(numNodes, 0);
+		uint32_t numCells = 1;
+		m_order.reserve(numNodes);
+		computeNestedDissection(nodes, neighbors, std::move(cell), cellIds, numCells, m_order);
+
+		m_ranks.assign(numNodes, noNode);
+		for (uint32_t i = 0; i < numNodes; ++i)
+			m_ranks[m_order[i]] = i;
+
+		std::vector< std::vector<uint32_t> > upwardArcs(numNodes);
+		for (uint32_t node : m_order)
+		{
+			// all remaining neighbors are of higher rank
+			upwardArcs[node] = std::move(neighbors[node]);
+			neighbors[node].clear();
+			const auto& up = upwardArcs[node];
+			for (uint32_t x : up)
+			{
+				auto& list = neighbors[x];
+				list.erase(std::lower_bound(list.begin(), list.end(), node));
+			}
+			for (size_t i = 0; i < up.size(); ++i)
+			{
+				for (size_t j = i + 1; j < up.size(); ++j)
+				{
+					addNeighbor(up[i], up[j]);
+					addNeighbor(up[j], up[i]);
+				}
+			}
+		}
+
+		m_firstArcs.reserve(numNodes + 1);
+		for (uint32_t i = 0; i < numNodes; ++i)
+		{
+			m_firstArcs.push_back(uint32_t(m_arcHeads.size()));
+			m_arcHeads.insert(m_arcHeads.end(), upwardArcs[i].begin(), upwardArcs[i].end());
+		}
+		m_firstArcs.push_back(uint32_t(m_arcHeads.size()));
+
+		m_upCosts.assign(m_arcHeads.size(), std::numeric_limits<double>::infinity());
+		m_downCosts.assign(m_arcHeads.size(), std::numeric_limits<double>::infinity());
+		m_upMiddles.assign(m_arcHeads.size(), noNode);
+		m_downMiddles.assign(m_arcHeads.size(), noNode);
+	}
+
+
+	const Network& ContractionHierarchy::getNetwork() const
+	{
+		return m_network;
+	}
+
+
+	size_t ContractionHierarchy::getNumArcs() const
+	{
+		return m_arcHeads.size();
+	}
+
+
+	void ContractionHierarchy::customize(const std::vector<double>& connectionCosts)
+	{
+		assert(m_topologyRevision == m_network.getTopologyRevision());
+		assert(connectionCosts.size() == m_network.getNumConnections());
+
+		std::fill(m_upCosts.begin(), m_upCosts.end(), std::numeric_limits<double>::infinity());
+		std::fill(m_downCosts.begin(), m_downCosts.end(), std::numeric_limits<double>::infinity());
+		std::fill(m_upMiddles.begin(), m_upMiddles.end(), noNode);
+		std::fill(m_downMiddles.begin(), m_downMiddles.end(), noNode);
+
+		for (const Connection& connection : m_network.getConnections())
+		{
+			const uint32_t start = uint32_t(connection.getStartNode().getIndex());
+			const uint32_t end = uint32_t(connection.getEndNode().getIndex());
+			if (start == end)
+				continue;
+
+			const double costs = connectionCosts[connection.getIndex()];
+			if (m_ranks[start] < m_ranks[end])
+			{
+				double& arcCosts = m_upCosts[findArc(start, end)];
+				arcCosts = std::min(arcCosts, costs);
+			}
+			else
+			{
+				double& arcCosts = m_downCosts[findArc(end, start)];
+				arcCosts = std::min(arcCosts, costs);
+			}
+		}
+
+		// Each shortcut x-y bypasses the lower ranked nodes v of all triangles v-x-y. Processing the nodes
+		// by ascending rank guarantees that the costs of v-x and v-y are final when v is processed.
+		for (uint32_t v : m_order)
+		{
+			for (uint32_t i = m_firstArcs[v]; i < m_firstArcs[v + 1]; ++i)
+			{
+				for (uint32_t j = i + 1; j < m_firstArcs[v + 1]; ++j)
+				{
+					// arc vx leads to the lower ranked node of the shortcut
+					const bool swap = (m_ranks[m_arcHeads[i]] > m_ranks[m_arcHeads[j]]);
+					const uint32_t vx = swap ? j : i;
+					const uint32_t vy = swap ? i : j;
+					const size_t xy = findArc(m_arcHeads[vx], m_arcHeads[vy]);
+
+					const double upCosts = m_downCosts[vx] + m_upCosts[vy];
+					if (upCosts < m_upCosts[xy])
+					{
+						m_upCosts[xy] = upCosts;
+						m_upMiddles[xy] = v;
+					}
+
+					const double downCosts = m_downCosts[vy] + m_upCosts[vx];
+					if (downCosts < m_downCosts[xy])
+					{
+						m_downCosts[xy] = downCosts;
+						m_downMiddles[xy] = v;
+					}
+				}
+			}
+		}
+	}
+
+
+	void ContractionHierarchy::customize(const TrafficState& trafficState, double targetVelocity)
+	{
+		std::vector<double> connectionCosts(m_network.getNumConnections());
+		for (const Connection& connection : m_network.getConnections())
+			connectionCosts[connection.getIndex()] = Routing::computeConnectionCosts(connection, trafficState, targetVelocity, true);
+		customize(connectionCosts);
+	}
+
+
+	double ContractionHierarchy::query(const Node& startNode, const std::vector<Node*>& destinationNodes, std::vector<const Connection*>& path) const
+	{
+		assert(m_topologyRevision == m_network.getTopologyRevision());
+		path.clear();
+
+		static thread_local QueryScratch scratch;
+		scratch.reset(m_ranks.size());
+		auto& forward = scratch.forward;
+		auto& backward = scratch.backward;
+
+		// forward search from the start node toward higher ranked nodes
+		const uint32_t start = uint32_t(startNode.getIndex());
+		forward.visit(start) = SearchEntry{ 0.0, noNode };
+		scratch.openList.push(0.0, start);
+		while (!scratch.openList.empty())
+		{
+			const auto ole = scratch.openList.pop();
+			if (ole.first > forward.get(ole.second).costs)
+				continue;
+
+			for (uint32_t a = m_firstArcs[ole.second]; a < m_firstArcs[ole.second + 1]; ++a)
+			{
+				const uint32_t head = m_arcHeads[a];
+				const double costs = ole.first + m_upCosts[a];
+				if (costs < getCosts(forward, head))
+				{
+					forward.visit(head) = SearchEntry{ costs, ole.second };
+					scratch.openList.push(costs, head);
+				}
+			}
+		}
+
+		// backward search from all destination nodes, meeting the forward search at the most important node of the path
+		for (const Node* node : destinationNodes)
+		{
+			const uint32_t index = uint32_t(node->getIndex());
+			backward.visit(index) = SearchEntry{ 0.0, noNode };
+			scratch.openList.push(0.0, index);
+		}
+
+		double bestCosts = std::numeric_limits<double>::infinity();
+		uint32_t meetingNode = noNode;
+		while (!scratch.openList.empty())
+		{
+			const auto ole = scratch.openList.pop();
+			if (ole.first > backward.get(ole.second).costs)
+				continue;
+			if (ole.first >= bestCosts)
+				break;
+
+			const double costs = getCosts(forward, ole.second) + ole.first;
+			if (costs < bestCosts)
+			{
+				bestCosts = costs;
+				meetingNode = ole.second;
+			}
+
+			for (uint32_t a = m_firstArcs[ole.second]; a < m_firstArcs[ole.second + 1]; ++a)
+			{
+				const uint32_t head = m_arcHeads[a];
+				const double costs = ole.first + m_downCosts[a];
+				if (costs < getCosts(backward, head))
+				{
+					backward.visit(head) = SearchEntry{ costs, ole.second };
+					scratch.openList.push(costs, head);
+				}
+			}
+		}
+
+		if (meetingNode == noNode)
+			return std::numeric_limits<double>::infinity();
+
+		// collect the nodes of the path in the hierarchy and unpack all shortcuts between them
+		auto& nodes = scratch.nodes;
+		nodes.clear();
+		for (uint32_t node = meetingNode; node != noNode; node = forward.get(node).parent)
+			nodes.push_back(node);
+		std::reverse(nodes.begin(), nodes.end());
+		for (uint32_t node = backward.get(meetingNode).parent; node != noNode; node = backward.get(node).parent)
+			nodes.push_back(node);
+
+		for (size_t i = 1; i < nodes.size(); ++i)
+			unpack(nodes[i - 1], nodes[i], path);
+		return bestCosts;
+	}
+
+
+	size_t ContractionHierarchy::findArc(uint32_t lower, uint32_t upper) const
+	{
+		auto first = m_arcHeads.begin() + m_firstArcs[lower];
+		auto last = m_arcHeads.begin() + m_firstArcs[lower + 1];
+		auto it = std::lower_bound(first, last, upper);
+		assert(it != last && *it == upper);
+		return size_t(it - m_arcHeads.begin());
+	}
+
+
+	void ContractionHierarchy::unpack(uint32_t from, uint32_t to, std::vector<const Connection*>& path) const
+	{
+		const uint32_t middle = (m_ranks[from] < m_ranks[to]) ? m_upMiddles[findArc(from, to)] : m_downMiddles[findArc(to, from)];
+		if (middle == noNode)
+		{
+			const auto& nodes = m_network.getNodes();
+			path.push_back(nodes[from]->getConnectionTo(*nodes[to]));
+			assert(path.back() != nullptr);
+		}
+		else
+		{
+			unpack(from, middle, path);
+			unpack(middle, to, path);
+		}
+	}
+
+
+}
+}
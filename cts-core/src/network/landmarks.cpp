@@ -0,0 +1,185 @@
+#include <cts-core/network/landmarks.h>
+#include <cts-core/network/connection.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+#include <cts-core/network/routing.h>
+#include <cts-core/network/shortestpaths.h>
+#include <cts-core/traffic/trafficstate.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace cts { namespace core
+{
+
+	Landmarks::Landmarks(const TrafficState& trafficState)
+		: m_trafficState(trafficState)
+		, m_network(trafficState.getNetwork())
+		, m_numLandmarks(4)
+		, m_topologyRevision(0)
+		, m_costRevision(0)
+	{
+
+	}
+
+
+	size_t Landmarks::getNumLandmarks() const
+	{
+		return m_numLandmarks;
+	}
+
+
+	void Landmarks::setNumLandmarks(size_t value)
+	{
+		if (value == m_numLandmarks)
+			return;
+
+		m_numLandmarks = value;
+		m_landmarkNodes.clear();
+		m_distancesFrom.clear();
+		m_distancesTo.clear();
+	}
+
+
+	bool Landmarks::isEnabled() const
+	{
+		return !m_landmarkNodes.empty();
+	}
+
+
+	const std::vector<const Node*>& Landmarks::getLandmarkNodes() const
+	{
+		return m_landmarkNodes;
+	}
+
+
+	bool Landmarks::update()
+	{
+		if (m_numLandmarks == 0 || m_network.getNumNodes() == 0)
+		{
+			const bool wasEnabled = isEnabled();
+			m_landmarkNodes.clear();
+			m_distancesFrom.clear();
+			m_distancesTo.clear();
+			return wasEnabled;
+		}
+
+		if (isEnabled() && m_topologyRevision == m_network.getTopologyRevision() && m_costRevision == m_network.getCostRevision())
+			return false;
+
+		// uncongested costs of the connections for vehicles that are only limited by the connections' target velocity,
+		// connections are visited through their start nodes to not allocate
+		const size_t numNodes = m_network.getNumNodes();
+		m_topologyRevision = m_network.getTopologyRevision();
+		m_costRevision = m_network.getCostRevision();
+		m_connectionCosts.assign(m_network.getNumConnections(), 0.0);
+		for (auto& node : m_network.getNodes())
+		{
+			for (const Connection* connection : node->getOutgoingConnections())
+				m_connectionCosts[connection->getIndex()] = Routing::computeConnectionCosts(*connection, m_trafficState, std::numeric_limits<double>::infinity(), false);
+		}
+
+		// Choose the landmarks one after another as the node farthest away from all previous ones
+		// (farthest point selection), starting with the node farthest away from the first node.
+		std::vector<double> minDistances;
+		computeDistances({ 0 }, true, minDistances);
+
+		std::vector< std::vector<double> > distancesFrom;
+		std::vector< std::vector<double> > distancesTo;
+		m_landmarkNodes.clear();
+		while (m_landmarkNodes.size() < m_numLandmarks)
+		{
+			size_t farthest = numNodes;
+			for (size_t i = 0; i < numNodes; ++i)
+			{
+				if (std::isfinite(minDistances[i]) && minDistances[i] > 0.0 && (farthest == numNodes || minDistances[i] > minDistances[farthest]))
+					farthest = i;
+			}
+			// all reachable nodes are landmarks already
+			if (farthest == numNodes)
+				break;
+
+			m_landmarkNodes.push_back(m_network.getNodes()[farthest].get());
+			distancesFrom.emplace_back();
+			distancesTo.emplace_back();
+			computeDistances({ farthest }, true, distancesFrom.back());
+			computeDistances({ farthest }, false, distancesTo.back());
+
+			for (size_t i = 0; i < numNodes; ++i)
+				minDistances[i] = std::min(minDistances[i], distancesFrom.back()[i]);
+		}
+
+		// store the distances interleaved, so that all bounds of a node share a cache line
+		const size_t numLandmarks = m_landmarkNodes.size();
+		m_distancesFrom.resize(numNodes * numLandmarks);
+		m_distancesTo.resize(numNodes * numLandmarks);
+		for (size_t i = 0; i < numNodes; ++i)
+		{
+			for (size_t l = 0; l < numLandmarks; ++l)
+			{
+				m_distancesFrom[i * numLandmarks + l] = distancesFrom[l][i];
+				m_distancesTo[i * numLandmarks + l] = distancesTo[l][i];
+			}
+		}
+		return true;
+	}
+
+
+	void Landmarks::prepareQuery(const std::vector<Node*>& destinationNodes, std::vector<double>& destinationBounds) const
+	{
+		// Instead of taking the minimum bound over all destination nodes for every visited node, the distances
+		// of the destination nodes are combined once per query:
+		//   d(v, D) >= min_d d(L, d) - d(L, v)   and   d(v, D) >= d(v, L) - max_d d(d, L)
+		const size_t numLandmarks = m_landmarkNodes.size();
+		destinationBounds.assign(2 * numLandmarks, 0.0);
+		for (size_t l = 0; l < numLandmarks; ++l)
+		{
+			double minDistanceFrom = std::numeric_limits<double>::infinity();
+			double maxDistanceTo = -std::numeric_limits<double>::infinity();
+			for (const Node* node : destinationNodes)
+			{
+				assert(node->getIndex() < m_network.getNumNodes());
+				minDistanceFrom = std::min(minDistanceFrom, m_distancesFrom[node->getIndex() * numLandmarks + l]);
+				maxDistanceTo = std::max(maxDistanceTo, m_distancesTo[node->getIndex() * numLandmarks + l]);
+			}
+			destinationBounds[2 * l] = minDistanceFrom;
+			destinationBounds[2 * l + 1] = maxDistanceTo;
+		}
+	}
+
+
+	double Landmarks::getLowerBound(const Node& node, const std::vector<double>& destinationBounds) const
+	{
+		const size_t numLandmarks = m_landmarkNodes.size();
+		assert(destinationBounds.size() == 2 * numLandmarks);
+		const double* distancesFrom = &m_distancesFrom[node.getIndex() * numLandmarks];
+		const double* distancesTo = &m_distancesTo[node.getIndex() * numLandmarks];
+
+		// bounds involving unreachable nodes are not finite and skipped
+		double toReturn = 0.0;
+		for (size_t l = 0; l < numLandmarks; ++l)
+		{
+			const double fromBound = destinationBounds[2 * l] - distancesFrom[l];
+			if (std::isfinite(fromBound))
+				toReturn = std::max(toReturn, fromBound);
+			const double toBound = distancesTo[l] - destinationBounds[2 * l + 1];
+			if (std::isfinite(toBound))
+				toReturn = std::max(toReturn, toBound);
+		}
+		return toReturn;
+	}
+
+
+	void Landmarks::computeDistances(const std::vector<size_t>& sources, bool forward, std::vector<double>& distances) const
+	{
+		OpenList openList;
+		computeShortestPaths(m_network, sources, forward, [this](const Connection& connection) {
+			return m_connectionCosts[connection.getIndex()];
+		}, openList, distances);
+	}
+
+
+}
+}
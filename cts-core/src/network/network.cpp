@@ -1,5 +1,7 @@
 #include <cts-core/network/network.h>
 #include <cts-core/base/log.h>
+#include <cts-core/base/spatialgrid.h>
+#include <cts-core/base/threadpool.h>
 #include <cts-core/base/utils.h>
 
 #include <tinyxml2.h>
@@ -9,6 +11,8 @@
 namespace cts { namespace core
 {
 	Network::Network()
+		: m_topologyRevision(0)
+		, m_costRevision(0)
 	{
 
 	}
@@ -16,13 +20,11 @@ namespace cts { namespace core
 
 	Network::~Network()
 	{
-		m_trafficMgr.clearVehicles();
-		m_vehicles.clear();
 		m_intersections.clear();
 	}
 
 
-	void Network::importLegacyXml(const std::string& filename)
+	void Network::importLegacyXml(const std::string& filename, size_t numThreads /*= 0*/)
 	{
 		LOG_TRACE_GUARD("core.Network")
 
@@ -82,11 +84,7 @@ namespace cts { namespace core
 		}
 
 
-		for (auto it = m_connections.begin(); it != m_connections.end(); ++it)
-		{
-			auto intersections = computeIntersections(**it, it, m_connections.end(), 4.0);
-			m_intersections.insert(m_intersections.end(), std::make_move_iterator(intersections.begin()), std::make_move_iterator(intersections.end()));
-		}
+		computeIntersections(4.0, numThreads);
 
 
 		auto tvNode = rootNode->FirstChildElement("TrafficVolumes");
@@ -130,7 +128,7 @@ namespace cts { namespace core
 				const int destinationHash = std::atoi(tvElement->FirstChildElement("destinationHash")->GetText());
 				const int numCars = std::atoi(tvElement->FirstChildElement("trafficVolumeCars")->GetText());
 
-				auto volume = m_trafficMgr.addVolume(startMap.find(startHash)->second.getNodes(), destinationMap.find(destinationHash)->second.getNodes());
+				auto volume = addVolume(startMap.find(startHash)->second.getNodes(), destinationMap.find(destinationHash)->second.getNodes());
 				volume->carsPerHour = numCars;
 			}
 		}
@@ -140,6 +138,8 @@ namespace cts { namespace core
 	Node* Network::addNode(const vec2& position)
 	{
 		m_nodes.push_back(std::make_unique<Node>(position));
+		m_nodes.back()->m_index = m_nodes.size() - 1;
+		++m_topologyRevision;
 		return m_nodes.back().get();
 	}
 
@@ -156,6 +156,8 @@ namespace cts { namespace core
 		}
 
 		utils::remove_erase_unique_ptr(m_nodes, &node);
+		updateNodeIndices();
+		++m_topologyRevision;
 	}
 
 
@@ -167,7 +169,10 @@ namespace cts { namespace core
 		auto connection = std::make_unique<Connection>(startNode, endNode);
 		startNode.m_outgoingConnections.push_back(connection.get());
 		endNode.m_incomingConnections.push_back(connection.get());
+		connection->m_network = this;
+		connection->m_index = m_connections.size();
 		m_connections.push_back(std::move(connection));
+		++m_topologyRevision;
 		return m_connections.back().get();
 	}
 
@@ -177,12 +182,27 @@ namespace cts { namespace core
 		utils::remove_erase(const_cast<Node&>(connection.m_startNode).m_outgoingConnections, &connection);
 		utils::remove_erase(const_cast<Node&>(connection.m_endNode).m_incomingConnections, &connection);
 		utils::remove_erase_unique_ptr(m_connections, &connection);
+		updateConnectionIndices();
+		++m_topologyRevision;
+	}
+
+
+	TrafficVolume* Network::addVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination)
+	{
+		m_volumes.push_back(std::make_unique<TrafficVolume>(start, destination));
+		return m_volumes.back().get();
+	}
+
+
+	void Network::removeVolume(TrafficVolume* volume)
+	{
+		utils::remove_erase_unique_ptr(m_volumes, volume);
 	}
 
 
-	TrafficManager& Network::getTrafficManager()
+	const Network::VolumeListType& Network::getVolumes() const
 	{
-		return m_trafficMgr;
+		return m_volumes;
 	}
 
 
@@ -209,9 +229,15 @@ namespace cts { namespace core
 	}
 
 
-	const Network::VehicleListType& Network::getVehicles() const
+	size_t Network::getNumNodes() const
 	{
-		return m_vehicles;
+		return m_nodes.size();
+	}
+
+
+	size_t Network::getNumConnections() const
+	{
+		return m_connections.size();
 	}
 
 
@@ -221,25 +247,84 @@ namespace cts { namespace core
 	}
 
 
+	size_t Network::getTopologyRevision() const
+	{
+		return m_topologyRevision;
+	}
+
+
+	size_t Network::getCostRevision() const
+	{
+		return m_costRevision;
+	}
+
+
+	void Network::updateNodeIndices()
+	{
+		for (size_t i = 0; i < m_nodes.size(); ++i)
+		{
+			m_nodes[i]->m_index = i;
+		}
+	}
+
+
+	void Network::updateConnectionIndices()
+	{
+		for (size_t i = 0; i < m_connections.size(); ++i)
+		{
+			m_connections[i]->m_index = i;
+		}
+	}
+
+
 	namespace
 	{
-		struct ParameterizationInfo
+		/// Part of a connection's curve with its support points and its time interval on the whole curve.
+		/// In contrast to BezierParameterization::getSubdividedFirst(), splitting parts does not modify the
+		/// curve, hence the intersections of several connections may be detected concurrently.
+		struct CurvePart
 		{
-			const BezierParameterization* parameterization;
+			std::array<vec2, 4> supportPoints;
+			Bounds2 bounds;
 			double startTime;
 			double endTime;
 		};
 
-		void computeIntersectionHelper(const Connection& lConn, const Connection& rConn, const ParameterizationInfo& lhs, const ParameterizationInfo& rhs, std::vector< std::pair<double, double> >& output, double tolerance)
+		/// Intersection with a later connection detected by findIntersections().
+		struct FoundIntersection
 		{
-			const Bounds2& otherBounds = rhs.parameterization->getBounds();
-			if (lhs.parameterization->getBounds().intersects(otherBounds))
+			Connection* other;		///< Other intersecting connection.
+			double time;			///< Time of the intersection on the connection.
+			double otherTime;		///< Time of the intersection on \e other.
+		};
+
+		CurvePart makeCurvePart(const std::array<vec2, 4>& supportPoints, double startTime, double endTime)
+		{
+			return CurvePart{ supportPoints, Bounds2(supportPoints), startTime, endTime };
+		}
+
+		void splitCurvePart(const CurvePart& part, CurvePart& first, CurvePart& second)
+		{
+			std::array<vec2, 4> firstPoints;
+			std::array<vec2, 4> secondPoints;
+			BezierParameterization::subdivide(part.supportPoints, firstPoints, secondPoints);
+			const double centerTime = part.startTime + (part.endTime - part.startTime) / 2.0;
+			first = makeCurvePart(firstPoints, part.startTime, centerTime);
+			second = makeCurvePart(secondPoints, centerTime, part.endTime);
+		}
+
+		void computeIntersectionHelper(const Connection& lConn, const Connection& rConn, const CurvePart& lhs, const CurvePart& rhs, std::vector< std::pair<double, double> >& output, double tolerance)
+		{
+			const Bounds2& otherBounds = rhs.bounds;
+			if (lhs.bounds.intersects(otherBounds))
 			{
 				double centerTime = rhs.startTime + (rhs.endTime - rhs.startTime) / 2.0;
 				if (otherBounds.volume() > tolerance)
 				{
-					computeIntersectionHelper(lConn, rConn, lhs, { &rhs.parameterization->getSubdividedFirst(), rhs.startTime, centerTime }, output, tolerance);
-					computeIntersectionHelper(lConn, rConn, lhs, { &rhs.parameterization->getSubdividedSecond(), centerTime, rhs.endTime }, output, tolerance);
+					CurvePart first, second;
+					splitCurvePart(rhs, first, second);
+					computeIntersectionHelper(lConn, rConn, lhs, first, output, tolerance);
+					computeIntersectionHelper(lConn, rConn, lhs, second, output, tolerance);
 				}
 				else
 				{
@@ -248,92 +333,135 @@ namespace cts { namespace core
 				}
 			}
 		}
-	}
 
-	Network::IntersectionListType Network::computeIntersections(Connection& connection, ConnectionListType::iterator start, ConnectionListType::iterator end, double tolerance)
-	{
-		std::vector<ParameterizationInfo> bigParts{ { &connection.getCurve(), 0.0, 1.0 } };
-		std::vector<ParameterizationInfo> smallParts;
-		while (!bigParts.empty())
+		/// Detects the intersections of \e connection with all given candidate connections.
+		/// Only reads the network, hence it may be called concurrently for different connections.
+		void findIntersections(const Connection& connection, const std::vector<Connection*>& candidates, double tolerance, std::vector<FoundIntersection>& output)
 		{
-			ParameterizationInfo part = bigParts.back();
-			bigParts.pop_back();
-			auto diagonal = part.parameterization->getBounds().getUrb() - part.parameterization->getBounds().getLlf();
-			if (diagonal[0] > tolerance || diagonal[1] > tolerance)
+			std::vector<CurvePart> bigParts{ makeCurvePart(connection.getCurve().getSupportPoints(), 0.0, 1.0) };
+			std::vector<CurvePart> smallParts;
+			while (!bigParts.empty())
 			{
-				bigParts.push_back({ &part.parameterization->getSubdividedFirst(), part.startTime, part.startTime + (part.endTime - part.startTime) / 2.0 });
-				bigParts.push_back({ &part.parameterization->getSubdividedSecond(), part.startTime + (part.endTime - part.startTime) / 2.0, part.endTime });
-			}
-			else
-			{
-				smallParts.push_back(part);
+				CurvePart part = bigParts.back();
+				bigParts.pop_back();
+				auto diagonal = part.bounds.getUrb() - part.bounds.getLlf();
+				if (diagonal[0] > tolerance || diagonal[1] > tolerance)
+				{
+					CurvePart first, second;
+					splitCurvePart(part, first, second);
+					bigParts.push_back(first);
+					bigParts.push_back(second);
+				}
+				else
+				{
+					smallParts.push_back(part);
+				}
 			}
-		}
 
-		// Collect all possible intersections in terms of parameterization times
-		IntersectionListType toReturn;
-		std::vector< std::pair<double, double> > intersectionTimes;
-		for (/**/; start != end; ++start)
-		{
-			auto& rConn = *start;
-			if (rConn.get() == &connection)
-				continue;
-
-			intersectionTimes.clear();
-			const auto& incomingConnections = connection.getStartNode().getIncomingConnections();
-			const auto& outgoingConnections = connection.getEndNode().getOutgoingConnections();
-			if (std::find(incomingConnections.begin(), incomingConnections.end(), rConn.get()) != incomingConnections.end())
-				continue;
-			if (std::find(outgoingConnections.begin(), outgoingConnections.end(), rConn.get()) != outgoingConnections.end())
-				continue;
-
-			ParameterizationInfo rPart{ &rConn->getCurve(), 0.0, 1.0 };
-			for (auto& lPart : smallParts)
+			// Collect all possible intersections in terms of parameterization times
+			std::vector< std::pair<double, double> > intersectionTimes;
+			for (Connection* rConn : candidates)
 			{
-				computeIntersectionHelper(connection, *rConn, lPart, rPart, intersectionTimes, tolerance);
-			}
+				if (rConn == &connection)
+					continue;
+
+				intersectionTimes.clear();
+				const auto& incomingConnections = connection.getStartNode().getIncomingConnections();
+				const auto& outgoingConnections = connection.getEndNode().getOutgoingConnections();
+				if (std::find(incomingConnections.begin(), incomingConnections.end(), rConn) != incomingConnections.end())
+					continue;
+				if (std::find(outgoingConnections.begin(), outgoingConnections.end(), rConn) != outgoingConnections.end())
+					continue;
+
+				const CurvePart rPart = makeCurvePart(rConn->getCurve().getSupportPoints(), 0.0, 1.0);
+				for (auto& lPart : smallParts)
+				{
+					computeIntersectionHelper(connection, *rConn, lPart, rPart, intersectionTimes, tolerance);
+				}
 
-			if (intersectionTimes.empty())
-				continue;
-			
+				if (intersectionTimes.empty())
+					continue;
 
-			// The following code does not work if we found only a single intersection.
-			// Instead of making it more complicated to support such scenarios, we simply duplicate the single found intersection.
-			if (intersectionTimes.size() == 1)
-				intersectionTimes.push_back(intersectionTimes[0]);
 
-			// merge intersections that are very close to each other
-			std::sort(intersectionTimes.begin(), intersectionTimes.end(), [](const std::pair<double, double>& lhs, const std::pair<double, double>& rhs) {
-				return lhs.first < rhs.first;
-			});
+				// The following code does not work if we found only a single intersection.
+				// Instead of making it more complicated to support such scenarios, we simply duplicate the single found intersection.
+				if (intersectionTimes.size() == 1)
+					intersectionTimes.push_back(intersectionTimes[0]);
 
-			size_t startIndex = 0;
-			double startArcPos = connection.getCurve().timeToArcPosition(intersectionTimes[0].first);
-			double lastArcPos = startArcPos;
-			for (size_t i = 0; i < intersectionTimes.size(); ++i)
-			{
-				const double currentArcPos = connection.getCurve().timeToArcPosition(intersectionTimes[i].first);
-				if (currentArcPos - lastArcPos > 42 || i+1 == intersectionTimes.size()) // FIXME: make constant configurable
-				{
-					toReturn.emplace_back(new Intersection(connection, intersectionTimes[startIndex].first + (intersectionTimes[i-1].first - intersectionTimes[startIndex].first) / 2.0, *rConn, intersectionTimes[startIndex + (i - 1 - startIndex) / 2].second));
-					connection.addIntersection(toReturn.back().get());
-					rConn->addIntersection(toReturn.back().get());
+				// merge intersections that are very close to each other
+				std::sort(intersectionTimes.begin(), intersectionTimes.end(), [](const std::pair<double, double>& lhs, const std::pair<double, double>& rhs) {
+					return lhs.first < rhs.first;
+				});
 
-					startIndex = i;
-					startArcPos = currentArcPos;
-					lastArcPos = currentArcPos;
+				size_t startIndex = 0;
+				double startArcPos = connection.getCurve().timeToArcPosition(intersectionTimes[0].first);
+				double lastArcPos = startArcPos;
+				for (size_t i = 0; i < intersectionTimes.size(); ++i)
+				{
+					const double currentArcPos = connection.getCurve().timeToArcPosition(intersectionTimes[i].first);
+					if (currentArcPos - lastArcPos > 42 || i+1 == intersectionTimes.size()) // FIXME: make constant configurable
+					{
+						output.push_back(FoundIntersection{ rConn, intersectionTimes[startIndex].first + (intersectionTimes[i-1].first - intersectionTimes[startIndex].first) / 2.0, intersectionTimes[startIndex + (i - 1 - startIndex) / 2].second });
+
+						startIndex = i;
+						startArcPos = currentArcPos;
+						lastArcPos = currentArcPos;
+					}
+					else
+					{
+						lastArcPos = currentArcPos;
+					}
 				}
-				else
+
+			}
+		}
+	}
+
+
+	void Network::computeIntersections(double tolerance, size_t numThreads)
+	{
+		// Only connections with overlapping bounds can intersect, the grid yields these candidates in ascending
+		// order so that the intersections are found in the same order as when testing all later connections.
+		std::vector<Bounds2> connectionBounds;
+		connectionBounds.reserve(m_connections.size());
+		for (auto& connection : m_connections)
+			connectionBounds.push_back(connection->getCurve().getBounds());
+		const SpatialGrid grid(std::move(connectionBounds));
+
+		// Detecting the intersections of each connection only reads the network, hence it runs concurrently.
+		std::vector< std::vector<FoundIntersection> > found(m_connections.size());
+		ThreadPool threadPool(numThreads);
+		threadPool.parallelFor(m_connections.size(), [this, &grid, &found, tolerance](size_t begin, size_t end) {
+			std::vector<size_t> candidateIndices;
+			std::vector<Connection*> candidates;
+			for (size_t i = begin; i < end; ++i)
+			{
+				grid.query(m_connections[i]->getCurve().getBounds(), candidateIndices);
+				candidates.clear();
+				for (size_t j : candidateIndices)
 				{
-					lastArcPos = currentArcPos;
+					if (j > i)
+						candidates.push_back(m_connections[j].get());
 				}
+				if (!candidates.empty())
+					findIntersections(*m_connections[i], candidates, tolerance, found[i]);
 			}
+		});
 
+		// Register the intersections in the same order as a sequential detection would.
+		for (size_t i = 0; i < m_connections.size(); ++i)
+		{
+			Connection& connection = *m_connections[i];
+			for (auto& fi : found[i])
+			{
+				std::unique_ptr<Intersection> intersection(new Intersection(connection, fi.time, *fi.other, fi.otherTime));
+				connection.addIntersection(intersection.get());
+				fi.other->addIntersection(intersection.get());
+				intersection->m_index = m_intersections.size();
+				m_intersections.push_back(std::move(intersection));
+			}
 		}
-
-		return toReturn;
 	}
 
-
 }
 }
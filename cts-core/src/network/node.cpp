@@ -11,6 +11,7 @@ namespace cts { namespace core
 		: m_position(position)
 		, m_inSlope(0.0, 0.0)
 		, m_outSlope(0.0, 0.0)
+		, m_index(0)
 	{
 
 	}
@@ -104,5 +105,11 @@ namespace cts { namespace core
 	}
 
 
+	size_t Node::getIndex() const
+	{
+		return m_index;
+	}
+
+
 }
 }
@@ -0,0 +1,48 @@
+#include <cts-core/network/route.h>
+
+#include <functional>
+#include <utility>
+
+namespace cts { namespace core
+{
+
+	Route::Route(std::vector<Segment> segments)
+		: m_segments(std::move(segments))
+		, m_hash(0)
+	{
+		for (auto& segment : m_segments)
+		{
+			// boost::hash_combine
+			m_hash ^= std::hash<const Connection*>()(segment.connection) + 0x9e3779b9 + (m_hash << 6) + (m_hash >> 2);
+			m_hash ^= std::hash<double>()(segment.costs) + 0x9e3779b9 + (m_hash << 6) + (m_hash >> 2);
+		}
+	}
+
+
+	const std::vector<Route::Segment>& Route::getSegments() const
+	{
+		return m_segments;
+	}
+
+
+	size_t Route::getHash() const
+	{
+		return m_hash;
+	}
+
+
+	bool Route::hasSameSegments(const Route& other) const
+	{
+		if (m_hash != other.m_hash || m_segments.size() != other.m_segments.size())
+			return false;
+
+		for (size_t i = 0; i < m_segments.size(); ++i)
+		{
+			if (m_segments[i].connection != other.m_segments[i].connection || m_segments[i].costs != other.m_segments[i].costs)
+				return false;
+		}
+		return true;
+	}
+
+}
+}
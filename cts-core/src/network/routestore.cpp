@@ -0,0 +1,124 @@
+#include <cts-core/network/routestore.h>
+#include <cts-core/network/node.h>
+#include <cts-core/traffic/trafficstate.h>
+
+#include <algorithm>
+#include <tuple>
+
+namespace cts { namespace core
+{
+
+	bool RouteStore::Query::operator<(const Query& rhs) const
+	{
+		return std::tie(startIndex, targetVelocity, destinationIndices) < std::tie(rhs.startIndex, rhs.targetVelocity, rhs.destinationIndices);
+	}
+
+
+	RouteStore::RouteStore(const TrafficState& trafficState)
+		: m_trafficState(trafficState)
+		, m_purgeSize(1024)
+		, m_queryRevision(0)
+		, m_numQueryHits(0)
+	{
+
+	}
+
+
+	RouteStore::Query RouteStore::makeQuery(const Node& startNode, const std::vector<Node*>& destinationNodes, double targetVelocity)
+	{
+		Query toReturn{ startNode.getIndex(), {}, targetVelocity };
+		toReturn.destinationIndices.reserve(destinationNodes.size());
+		for (const Node* node : destinationNodes)
+			toReturn.destinationIndices.push_back(node->getIndex());
+		std::sort(toReturn.destinationIndices.begin(), toReturn.destinationIndices.end());
+		return toReturn;
+	}
+
+
+	bool RouteStore::isQueryCacheEnabled() const
+	{
+		return m_trafficState.isCostSnapshotEnabled();
+	}
+
+
+	std::shared_ptr<const Route> RouteStore::find(const Query& query)
+	{
+		if (!isQueryCacheEnabled() || m_queryRevision != m_trafficState.getCongestionRevision())
+			return nullptr;
+
+		auto it = m_queries.find(query);
+		if (it == m_queries.end())
+			return nullptr;
+
+		++m_numQueryHits;
+		return it->second;
+	}
+
+
+	void RouteStore::insert(const Query& query, std::shared_ptr<const Route> route)
+	{
+		if (route == nullptr || !isQueryCacheEnabled())
+			return;
+
+		if (m_queryRevision != m_trafficState.getCongestionRevision())
+		{
+			m_queries.clear();
+			m_queryRevision = m_trafficState.getCongestionRevision();
+		}
+		m_queries[query] = std::move(route);
+	}
+
+
+	std::shared_ptr<const Route> RouteStore::intern(const std::shared_ptr<const Route>& route)
+	{
+		auto range = m_routes.equal_range(route->getHash());
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			std::shared_ptr<const Route> interned = it->second.lock();
+			if (interned != nullptr && interned->hasSameSegments(*route))
+				return interned;
+		}
+
+		if (m_routes.size() >= m_purgeSize)
+		{
+			purge();
+			m_purgeSize = std::max(m_purgeSize, 2 * m_routes.size());
+		}
+		m_routes.emplace(route->getHash(), route);
+		return route;
+	}
+
+
+	void RouteStore::clear()
+	{
+		m_queries.clear();
+	}
+
+
+	size_t RouteStore::getNumRoutes() const
+	{
+		return std::count_if(m_routes.begin(), m_routes.end(), [](const std::pair< const size_t, std::weak_ptr<const Route> >& entry) {
+			return !entry.second.expired();
+		});
+	}
+
+
+	size_t RouteStore::getNumQueryHits() const
+	{
+		return m_numQueryHits;
+	}
+
+
+	void RouteStore::purge()
+	{
+		for (auto it = m_routes.begin(); it != m_routes.end(); /**/)
+		{
+			if (it->second.expired())
+				it = m_routes.erase(it);
+			else
+				++it;
+		}
+	}
+
+}
+}
@@ -0,0 +1,106 @@
+#include <cts-core/network/routetreecache.h>
+#include <cts-core/network/connection.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+#include <cts-core/network/routing.h>
+#include <cts-core/network/shortestpaths.h>
+#include <cts-core/traffic/trafficstate.h>
+
+#include <algorithm>
+
+namespace cts { namespace core
+{
+
+	RouteTreeCache::RouteTreeCache(const TrafficState& trafficState)
+		: m_trafficState(trafficState)
+		, m_refreshInterval(0.0)
+		, m_lastRefreshTime(0.0)
+		, m_topologyRevision(trafficState.getNetwork().getTopologyRevision())
+		, m_numTreeComputations(0)
+	{
+
+	}
+
+
+	bool RouteTreeCache::isEnabled() const
+	{
+		return m_refreshInterval > 0.0;
+	}
+
+
+	double RouteTreeCache::getRefreshInterval() const
+	{
+		return m_refreshInterval;
+	}
+
+
+	void RouteTreeCache::setRefreshInterval(double value)
+	{
+		m_refreshInterval = std::max(0.0, value);
+	}
+
+
+	void RouteTreeCache::update(double currentTime)
+	{
+		const size_t topologyRevision = m_trafficState.getNetwork().getTopologyRevision();
+		if (topologyRevision != m_topologyRevision)
+		{
+			// trees of removed destinations would never be used again
+			m_trees.clear();
+			m_topologyRevision = topologyRevision;
+			m_lastRefreshTime = currentTime;
+		}
+		else if (currentTime < m_lastRefreshTime || currentTime >= m_lastRefreshTime + m_refreshInterval)
+		{
+			// the simulation might have been reset in the meantime
+			invalidate();
+			m_lastRefreshTime = currentTime;
+		}
+	}
+
+
+	void RouteTreeCache::invalidate()
+	{
+		for (auto& tree : m_trees)
+			tree.second.outdated = true;
+	}
+
+
+	const RouteTreeCache::Tree& RouteTreeCache::getTree(const std::vector<Node*>& destinationNodes, double targetVelocity)
+	{
+		m_key.first.clear();
+		for (const Node* node : destinationNodes)
+			m_key.first.push_back(node->getIndex());
+		std::sort(m_key.first.begin(), m_key.first.end());
+		m_key.second = targetVelocity;
+
+		auto it = m_trees.find(m_key);
+		if (it == m_trees.end())
+			it = m_trees.emplace(m_key, Tree{ {}, {}, true }).first;
+
+		Tree& tree = it->second;
+		if (tree.outdated)
+			computeTree(tree, m_key.first, targetVelocity);
+		return tree;
+	}
+
+
+	size_t RouteTreeCache::getNumTreeComputations() const
+	{
+		return m_numTreeComputations;
+	}
+
+
+	void RouteTreeCache::computeTree(Tree& tree, const std::vector<size_t>& destinationIndices, double targetVelocity)
+	{
+		tree.outdated = false;
+		++m_numTreeComputations;
+
+		computeShortestPaths(m_trafficState.getNetwork(), destinationIndices, false, [this, targetVelocity](const Connection& connection) {
+			return Routing::computeConnectionCosts(connection, m_trafficState, targetVelocity, true);
+		}, m_openList, tree.costsToGo, &tree.nextConnections);
+	}
+
+
+}
+}
@@ -1,143 +1,399 @@
 #include <cts-core/base/utils.h>
 #include <cts-core/network/connection.h>
+#include <cts-core/network/contractionhierarchy.h>
+#include <cts-core/network/landmarks.h>
+#include <cts-core/network/network.h>
 #include <cts-core/network/node.h>
+#include <cts-core/network/routestore.h>
 #include <cts-core/network/routing.h>
+#include <cts-core/network/shortestpaths.h>
+#include <cts-core/traffic/trafficstate.h>
 #include <cts-core/traffic/vehicle.h>
 
 
 #include <algorithm>
-#include <memory>
-#include <numeric>
-#include <queue>
-#include <set>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
 namespace cts { namespace core
 {
 
 	namespace
 	{
-		struct OpenListElement
+		/// Search state of a single node during Routing::compute().
+		struct NodeEntry
 		{
-			OpenListElement(const Node& node, const std::shared_ptr<OpenListElement>& parent, int numParents, double previousCosts, double heuristicFullCosts)
-				: node(node)
-				, parent(parent)
-				, numParents(numParents)
-				, previousCosts(previousCosts)
-				, heuristicFullCosts(heuristicFullCosts)
-			{}
-
-			const Node& node;							///< Node to investigate next
-			std::shared_ptr<OpenListElement> parent;	///< Parent OpenListElement
-			int numParents;								///< Number of parent elements
-			double previousCosts;						///< Exact costs up to this element's node
-			double heuristicFullCosts;					///< previousCosts + expected costs from element's node to the target node
+			uint32_t heapPosition;		///< Position in the open list, closedPosition if the node was investigated already.
+			int numParents;				///< Number of connections on the path to this node
+			const Node* parent;			///< Previous node on the path to this node
+			double previousCosts;		///< Exact costs up to this node
+			double remainingCosts;		///< Expected costs from this node to the target node, computed once per search
+			double heuristicFullCosts;	///< previousCosts + expected costs from this node to the target node
 		};
 
-		static bool operator<(const std::shared_ptr<OpenListElement>& lhs, const std::shared_ptr<OpenListElement>& rhs)
-		{
-			return lhs->heuristicFullCosts > rhs->heuristicFullCosts;
-		}
+		static const uint32_t closedPosition = std::numeric_limits<uint32_t>::max();
 
-		template< class T, class Comp = std::less<T> >
-		class RandomAccessPriorityQueue : public std::priority_queue<T, std::vector<T>, Comp>
+		/**
+		 * Per-thread scratch buffers of Routing::compute(): the search state of each node and an indexed
+		 * open list that allows to decrease the costs of the nodes in it.
+		 */
+		class RoutingScratch
 		{
 		public:
-			RandomAccessPriorityQueue() = default;
-			virtual ~RandomAccessPriorityQueue() = default;
+			/// Starts a new search over \e numNodes nodes.
+			void reset(size_t numNodes)
+			{
+				m_entries.reset(numNodes);
+				m_heap.clear();
+			}
+
+			/// Returns the entry of the node with the given index, nullptr if it was not visited during this search.
+			NodeEntry* find(size_t index)
+			{
+				return m_entries.find(index);
+			}
+
+			/// Returns the entry of the node with the given index.
+			NodeEntry& get(size_t index)
+			{
+				return m_entries.get(index);
+			}
+
+			bool isOpenListEmpty() const
+			{
+				return m_heap.empty();
+			}
+
+			/// Adds the node with the given index to the open list, its entry must not be visited yet.
+			void push(uint32_t index, const Node* parent, int numParents, double previousCosts, double remainingCosts)
+			{
+				m_entries.visit(index) = NodeEntry{ uint32_t(m_heap.size()), numParents, parent, previousCosts, remainingCosts, previousCosts + remainingCosts };
+				m_heap.push_back(index);
+				siftUp(m_heap.size() - 1);
+			}
 
-			template<typename UnaryPredicate>
-			void remove_erase_if(UnaryPredicate&& predicate)
+			/// Replaces the path to the node with the given index, which must be in the open list and
+			/// must not get more expensive.
+			void decrease(uint32_t index, const Node* parent, int numParents, double previousCosts)
 			{
-				utils::remove_erase_if(c, std::move(predicate));
-				std::make_heap(c.begin(), c.end(), Comp());
+				assert(m_entries.find(index) != nullptr);
+				NodeEntry& entry = m_entries.get(index);
+				assert(entry.heapPosition != closedPosition);
+				assert(previousCosts + entry.remainingCosts <= entry.heuristicFullCosts);
+
+				entry.parent = parent;
+				entry.numParents = numParents;
+				entry.previousCosts = previousCosts;
+				entry.heuristicFullCosts = previousCosts + entry.remainingCosts;
+				siftUp(entry.heapPosition);
+			}
+
+			/// Removes the cheapest node from the open list, marks it as closed and returns its index.
+			uint32_t pop()
+			{
+				assert(!m_heap.empty());
+				const uint32_t toReturn = m_heap.front();
+				m_entries.get(toReturn).heapPosition = closedPosition;
+
+				const uint32_t last = m_heap.back();
+				m_heap.pop_back();
+				if (!m_heap.empty())
+				{
+					m_heap.front() = last;
+					m_entries.get(last).heapPosition = 0;
+					siftDown(0);
+				}
+				return toReturn;
+			}
+
+		private:
+			/// Ordering of the open list, ties are broken by the node index to keep the search deterministic.
+			bool isCheaper(uint32_t lhs, uint32_t rhs) const
+			{
+				const double lhsCosts = m_entries.get(lhs).heuristicFullCosts;
+				const double rhsCosts = m_entries.get(rhs).heuristicFullCosts;
+				return lhsCosts < rhsCosts || (lhsCosts == rhsCosts && lhs < rhs);
+			}
+
+			void place(size_t position, uint32_t index)
+			{
+				m_heap[position] = index;
+				m_entries.get(index).heapPosition = uint32_t(position);
 			}
+
+			void siftUp(size_t position)
+			{
+				const uint32_t index = m_heap[position];
+				while (position > 0)
+				{
+					const size_t parent = (position - 1) / 2;
+					if (!isCheaper(index, m_heap[parent]))
+						break;
+					place(position, m_heap[parent]);
+					position = parent;
+				}
+				place(position, index);
+			}
+
+			void siftDown(size_t position)
+			{
+				const uint32_t index = m_heap[position];
+				const size_t size = m_heap.size();
+				for (;;)
+				{
+					size_t child = 2 * position + 1;
+					if (child >= size)
+						break;
+					if (child + 1 < size && isCheaper(m_heap[child + 1], m_heap[child]))
+						++child;
+					if (!isCheaper(m_heap[child], index))
+						break;
+					place(position, m_heap[child]);
+					position = child;
+				}
+				place(position, index);
+			}
+
+			NodeScratch<NodeEntry> m_entries;	///< Search state of each node.
+			std::vector<uint32_t> m_heap;		///< Open list, binary min-heap of node indices.
 		};
 	}
 
 
-	const std::vector<Routing::Segment>& Routing::getSegments() const
+	const Routing::SegmentRange& Routing::getSegments() const
 	{
 		return m_segments;
 	}
 
 
-	void Routing::compute(const Node& startNode, const std::vector<Node*>& destinationNodes, const AbstractVehicle& vehicle)
+	const std::shared_ptr<const Route>& Routing::getRoute() const
+	{
+		return m_route;
+	}
+
+
+	size_t Routing::getSegmentIndex() const
 	{
-		m_segments.clear();
+		return m_index;
+	}
+
+
+	void Routing::setRoute(std::shared_ptr<const Route> route, size_t index)
+	{
+		assert(route == nullptr || index <= route->getSegments().size());
+		m_route = std::move(route);
+		m_index = (m_route != nullptr) ? index : 0;
+		m_segments.m_begin = (m_route != nullptr) ? m_route->getSegments().data() + m_index : nullptr;
+		m_segments.m_end = (m_route != nullptr) ? m_route->getSegments().data() + m_route->getSegments().size() : nullptr;
+	}
+
+
+	void Routing::intern(RouteStore& store)
+	{
+		if (m_route != nullptr)
+			setRoute(store.intern(m_route), m_index);
+	}
+
+
+	void Routing::setSegments(std::vector<Segment> segments)
+	{
+		if (segments.empty())
+			setRoute(nullptr);
+		else
+			setRoute(std::make_shared<const Route>(std::move(segments)));
+	}
+
+
+	size_t Routing::getNumExpandedNodes() const
+	{
+		return m_numExpandedNodes;
+	}
+
 
+	void Routing::advance()
+	{
+		assert(!m_segments.empty());
+		++m_index;
+		++m_segments.m_begin;
+	}
+
+
+	void Routing::continueWith(const Routing& continuation)
+	{
+		assert(!m_segments.empty());
+		assert(continuation.m_segments.empty() || continuation.m_segments.front().start == m_segments.front().destination);
+
+		// the route is shared with other vehicles, hence create a new one
+		std::vector<Segment> segments;
+		segments.reserve(1 + continuation.m_segments.size());
+		segments.push_back(m_segments.front());
+		segments.insert(segments.end(), continuation.m_segments.begin(), continuation.m_segments.end());
+		setSegments(std::move(segments));
+	}
+
+
+	double Routing::computeCostChange(const AbstractVehicle& vehicle) const
+	{
+		double plannedCosts = 0.0;
+		double currentCosts = 0.0;
+		for (auto& segment : m_segments)
+		{
+			plannedCosts += segment.costs;
+			currentCosts += computeConnectionCosts(*segment.connection, vehicle, true);
+		}
+
+		return (plannedCosts > 0.0) ? std::abs(currentCosts - plannedCosts) / plannedCosts : 0.0;
+	}
+
+
+	double Routing::computeConnectionCosts(const Connection& connection, const AbstractVehicle& vehicle, bool congested)
+	{
+		return computeConnectionCosts(connection, vehicle.getTrafficState(), vehicle.getTargetVelocity(), congested);
+	}
+
+
+	double Routing::computeConnectionCosts(const Connection& connection, const TrafficState& trafficState, double targetVelocity, bool congested)
+	{
+		// The following computation of the cost function is hand-crafted and taken from the original C# implementation of CTS...
+		// Base costs are the the arc length of the connection, if the connection is congested, we induce a penalty
+		double connectionCosts = congested ? trafficState.getCongestedArcLength(connection) : connection.getCurve().getArcLength();
+		// consider the target velocity
+		connectionCosts *= 14.0 / std::min(targetVelocity, connection.getTargetVelocity());
+		return connectionCosts;
+	}
+
+
+	double Routing::computeCongestedArcLength(const Connection& connection, size_t numVehicles)
+	{
 		// TODO: move these constants somewhere more central where they make sense
 		static const double VehicleOnRoutePenalty = 48.0;
+
+		return connection.getCurve().getArcLength() + numVehicles * VehicleOnRoutePenalty;
+	}
+
+
+	void Routing::compute(const ContractionHierarchy& hierarchy, const Node& startNode, const std::vector<Node*>& destinationNodes, const AbstractVehicle& vehicle)
+	{
+		m_numExpandedNodes = 0;
+
+		static thread_local std::vector<const Connection*> path;
+		hierarchy.query(startNode, destinationNodes, path);
+		std::vector<Segment> segments;
+		segments.reserve(path.size());
+		for (const Connection* connection : path)
+		{
+			segments.push_back(Segment{ connection, &connection->getStartNode(), &connection->getEndNode(), computeConnectionCosts(*connection, vehicle, true) });
+		}
+		setSegments(std::move(segments));
+	}
+
+
+	void Routing::follow(const RouteTreeCache::Tree& tree, const Node& startNode, const AbstractVehicle& vehicle)
+	{
+		m_numExpandedNodes = 0;
+		assert(startNode.getIndex() < tree.nextConnections.size());
+
+		std::vector<Segment> segments;
+		for (const Connection* connection = tree.nextConnections[startNode.getIndex()]; connection != nullptr; connection = tree.nextConnections[connection->getEndNode().getIndex()])
+		{
+			segments.push_back(Segment{ connection, &connection->getStartNode(), &connection->getEndNode(), computeConnectionCosts(*connection, vehicle, true) });
+		}
+		setSegments(std::move(segments));
+	}
+
+
+	void Routing::compute(const Node& startNode, const std::vector<Node*>& destinationNodes, const AbstractVehicle& vehicle)
+	{
+		compute(startNode, destinationNodes, vehicle.getTrafficState(), vehicle.getTargetVelocity());
+	}
+
+
+	void Routing::compute(const Node& startNode, const std::vector<Node*>& destinationNodes, const TrafficState& trafficState, double targetVelocity)
+	{
+		setRoute(nullptr);
+		m_numExpandedNodes = 0;
 		if (destinationNodes.empty())
 			return;
 
-		RandomAccessPriorityQueue< std::shared_ptr<OpenListElement> > openList;
-		std::set<const Node*> closedList;
+		const auto& nodes = trafficState.getNetwork().getNodes();
+		assert(startNode.getIndex() < nodes.size() && nodes[startNode.getIndex()].get() == &startNode);
+
+		static thread_local RoutingScratch scratch;
+		scratch.reset(nodes.size());
+
+		const Landmarks& landmarks = trafficState.getLandmarks();
+		const bool useLandmarks = landmarks.isEnabled();
+		static thread_local std::vector<double> destinationBounds;
+		if (useLandmarks)
+			landmarks.prepareQuery(destinationNodes, destinationBounds);
 
-		openList.push(std::make_shared<OpenListElement>(startNode, nullptr, 0, 0.0, 0.0));
+		scratch.push(uint32_t(startNode.getIndex()), nullptr, 0, 0.0, 0.0);
 		do {
-			std::shared_ptr<OpenListElement> ole = openList.top();
-			openList.pop();
+			const uint32_t index = scratch.pop();
+			++m_numExpandedNodes;
+			const Node& node = *nodes[index];
+			const NodeEntry ole = scratch.get(index);
 
-			// We found the shortest route, convert the OpenListElement into a list of routing segments
-			if (utils::contains(destinationNodes, &ole->node))
+			// We found the shortest route, convert the parent chain into a list of routing segments
+			if (utils::contains(destinationNodes, &node))
 			{
-				m_segments.reserve(ole->numParents);
-				for (OpenListElement* currentNode = ole.get(); currentNode->parent != nullptr; currentNode = currentNode->parent.get())
+				std::vector<Segment> segments;
+				segments.reserve(ole.numParents);
+				for (const Node* currentNode = &node; scratch.get(currentNode->getIndex()).parent != nullptr; /**/)
 				{
-					m_segments.push_back(Segment{ currentNode->parent->node.getConnectionTo(currentNode->node), &currentNode->parent->node, &currentNode->node });
+					const Node* parent = scratch.get(currentNode->getIndex()).parent;
+					const Connection* connection = parent->getConnectionTo(*currentNode);
+					segments.push_back(Segment{ connection, parent, currentNode, computeConnectionCosts(*connection, trafficState, targetVelocity, true) });
+					currentNode = parent;
 				}
 
-				std::reverse(m_segments.begin(), m_segments.end());
+				std::reverse(segments.begin(), segments.end());
+				setSegments(std::move(segments));
 				return;
 			}
 			
-			closedList.insert(&ole->node);
-			for (auto& conn : ole->node.getOutgoingConnections())
+			for (auto& conn : node.getOutgoingConnections())
 			{
 				// TODO: add check whether this vehicle is allowed to use the connection
 
 				// check whether we have investigated this node already
-				if (closedList.find(&conn->getEndNode()) != closedList.end()) 
+				const uint32_t endIndex = uint32_t(conn->getEndNode().getIndex());
+				assert(endIndex < nodes.size() && nodes[endIndex].get() == &conn->getEndNode());
+				NodeEntry* endEntry = scratch.find(endIndex);
+				if (endEntry != nullptr && endEntry->heapPosition == closedPosition)
 					continue;
 
-				// The following computation of the cost function is hand-crafted and taken from the original C# implementation of CTS...
-				// Base costs are the the arc length of the connection
-				double connectionCosts = conn->getCurve().getArcLength();
-				// If the connection is congested, we induce a penalty, however only for the next two connections (otherwise the AI would not be able to know about that)
-				if (ole->numParents < 3)
-					connectionCosts += conn->getVehicles().size() * VehicleOnRoutePenalty;
-				// consider the target velocity
-				connectionCosts *= 14.0 / std::min(vehicle.getTargetVelocity(), conn->getTargetVelocity());
+				// The congestion penalty only applies to the next connections (otherwise the AI would not be able to know about that)
+				const double connectionCosts = computeConnectionCosts(*conn, trafficState, targetVelocity, ole.numParents < 3);
 				
-				const vec2 startPosition = conn->getEndNode().getPosition();
-				const double remainingCosts = utils::reduce(destinationNodes, std::numeric_limits<double>::max(), [startPosition](double minimum, Node* node) {
-					return std::min(minimum, math::distance(startPosition, node->getPosition()));
-				});
-
-				// check whether know already a better path to the end node of conn than the one we're currently examining.
-				const double fullCosts = ole->previousCosts + connectionCosts + remainingCosts;
-				bool nodeInOpenlist = false;
-
-				openList.remove_erase_if([&](const std::shared_ptr<OpenListElement>& ole) {
-					if (&ole->node == &conn->getEndNode())
+				// the heuristic only depends on the node, hence it is computed once when the node is reached first
+				if (endEntry == nullptr)
+				{
+					double remainingCosts;
+					if (useLandmarks)
 					{
-						if (ole->heuristicFullCosts < fullCosts)
-						{
-							nodeInOpenlist = true;
-						}
-						else
-						{
-							return true;
-						}
+						remainingCosts = landmarks.getLowerBound(conn->getEndNode(), destinationBounds);
 					}
-					return false;
-				});
-
-				if (!nodeInOpenlist)
-					openList.push(std::make_shared<OpenListElement>(conn->getEndNode(), ole, ole->numParents + 1, ole->previousCosts + connectionCosts, fullCosts));
+					else
+					{
+						const vec2 startPosition = conn->getEndNode().getPosition();
+						remainingCosts = utils::reduce(destinationNodes, std::numeric_limits<double>::max(), [startPosition](double minimum, Node* node) {
+							return std::min(minimum, math::distance(startPosition, node->getPosition()));
+						});
+					}
+					scratch.push(endIndex, &node, ole.numParents + 1, ole.previousCosts + connectionCosts, remainingCosts);
+				}
+				// check whether know already a better path to the end node of conn than the one we're currently examining.
+				else if (!(endEntry->heuristicFullCosts < ole.previousCosts + connectionCosts + endEntry->remainingCosts))
+				{
+					scratch.decrease(endIndex, &node, ole.numParents + 1, ole.previousCosts + connectionCosts);
+				}
 			}
 
-		} while (!openList.empty());
+		} while (!scratch.isOpenListEmpty());
 
 	}
 
@@ -0,0 +1,164 @@
+#include <cts-core/base/threadpool.h>
+#include <cts-core/network/network.h>
+#include <cts-core/simulation/replicationrunner.h>
+#include <cts-core/simulation/simulation.h>
+
+#include <cassert>
+#include <chrono>
+
+namespace cts { namespace core
+{
+
+
+	ReplicationRunner::ReplicationRunner(const Network& network)
+		: m_network(network)
+		, m_duration(3600.0)
+		, m_ticksPerSecond(15.0)
+		, m_trafficMultiplier(1.0)
+		, m_routeTreeInterval(0.0)
+		, m_costSnapshotInterval(0.0)
+		, m_asyncRouting(false)
+		, m_numThreads(0)
+	{
+
+	}
+
+
+	double ReplicationRunner::getDuration() const
+	{
+		return m_duration;
+	}
+
+
+	void ReplicationRunner::setDuration(double value)
+	{
+		m_duration = value;
+	}
+
+
+	double ReplicationRunner::getTicksPerSecond() const
+	{
+		return m_ticksPerSecond;
+	}
+
+
+	void ReplicationRunner::setTicksPerSecond(double value)
+	{
+		assert(value > 0.0);
+		m_ticksPerSecond = value;
+	}
+
+
+	double ReplicationRunner::getTrafficMultiplier() const
+	{
+		return m_trafficMultiplier;
+	}
+
+
+	void ReplicationRunner::setTrafficMultiplier(double value)
+	{
+		m_trafficMultiplier = value;
+	}
+
+
+	double ReplicationRunner::getRouteTreeInterval() const
+	{
+		return m_routeTreeInterval;
+	}
+
+
+	void ReplicationRunner::setRouteTreeInterval(double value)
+	{
+		m_routeTreeInterval = value;
+	}
+
+
+	double ReplicationRunner::getCostSnapshotInterval() const
+	{
+		return m_costSnapshotInterval;
+	}
+
+
+	void ReplicationRunner::setCostSnapshotInterval(double value)
+	{
+		m_costSnapshotInterval = value;
+	}
+
+
+	bool ReplicationRunner::isAsyncRouting() const
+	{
+		return m_asyncRouting;
+	}
+
+
+	void ReplicationRunner::setAsyncRouting(bool value)
+	{
+		m_asyncRouting = value;
+	}
+
+
+	size_t ReplicationRunner::getNumThreads() const
+	{
+		return m_numThreads;
+	}
+
+
+	void ReplicationRunner::setNumThreads(size_t value)
+	{
+		m_numThreads = value;
+	}
+
+
+	ReplicationRunner::Report ReplicationRunner::run(const std::vector<uint32_t>& seeds) const
+	{
+		Report toReturn;
+		toReturn.results.resize(seeds.size());
+
+		const auto timeBefore = std::chrono::steady_clock::now();
+		ThreadPool threadPool(m_numThreads);
+		threadPool.parallelFor(seeds.size(), [this, &seeds, &toReturn](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				toReturn.results[i] = runReplication(seeds[i]);
+		});
+		toReturn.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - timeBefore).count();
+
+		return toReturn;
+	}
+
+
+	ReplicationRunner::Result ReplicationRunner::runReplication(uint32_t seed) const
+	{
+		const auto timeBefore = std::chrono::steady_clock::now();
+
+		Simulation simulation(m_network);
+		simulation.setTicksPerSecond(m_ticksPerSecond);
+		simulation.reset(seed);
+
+		TrafficManager& trafficManager = simulation.getTrafficManager();
+		trafficManager.setGlobalTrafficMultiplier(m_trafficMultiplier);
+		trafficManager.setRouteTreeInterval(m_routeTreeInterval);
+		trafficManager.setCostSnapshotInterval(m_costSnapshotInterval);
+		trafficManager.setAsyncRouting(m_asyncRouting);
+		// replications are already running concurrently, the traffic manager keeps its default of a single
+		// thread and thus never starts workers that would oversubscribe the CPU
+		assert(trafficManager.getNumThreads() == 1);
+
+		Result toReturn;
+		toReturn.seed = seed;
+		toReturn.numTicks = 0;
+		while (simulation.getCurrentTime() < m_duration)
+		{
+			simulation.step();
+			++toReturn.numTicks;
+		}
+
+		toReturn.simulatedTime = simulation.getCurrentTime();
+		toReturn.numRemainingVehicles = trafficManager.getVehicles().size();
+		toReturn.statistics = trafficManager.getStatistics();
+		toReturn.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - timeBefore).count();
+		return toReturn;
+	}
+
+
+}
+}
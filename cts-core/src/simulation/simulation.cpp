@@ -1,7 +1,12 @@
+#include <cts-core/network/connection.h>
 #include <cts-core/network/network.h>
 #include <cts-core/simulation/randomizer.h>
 #include <cts-core/simulation/simulation.h>
+#include <cts-core/traffic/trafficmanager.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehicle.h>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <thread>
@@ -10,14 +15,20 @@ namespace cts { namespace core
 {
 
 
-	Simulation::Simulation(Network& network)
+	Simulation::Simulation(const Network& network)
 		: m_speed(3.0)
 		, m_ticksPerSecond(30.0)
 		, m_duration(0.0)
+		, m_pacingMode(PacingMode::RealTime)
+		, m_maxCatchUpTicks(5)
+		, m_realTimeFactor(0.0)
 		, m_currentTime(0.0)
 		, m_stopSimulation(false)
 		, m_randomizer(new Randomizer())
 		, m_network(network)
+		, m_trafficState(new TrafficState(network))
+		, m_trafficManager(new TrafficManager(network, *m_trafficState))
+		, m_renderSnapshotsEnabled(false)
 	{
 
 	}
@@ -29,6 +40,30 @@ namespace cts { namespace core
 	}
 
 
+	const Network& Simulation::getNetwork() const
+	{
+		return m_network;
+	}
+
+
+	TrafficManager& Simulation::getTrafficManager()
+	{
+		return *m_trafficManager;
+	}
+
+
+	const TrafficManager& Simulation::getTrafficManager() const
+	{
+		return *m_trafficManager;
+	}
+
+
+	const TrafficState& Simulation::getTrafficState() const
+	{
+		return *m_trafficState;
+	}
+
+
 	const Randomizer& Simulation::getRandomizer() const
 	{
 		return *m_randomizer;
@@ -73,6 +108,56 @@ namespace cts { namespace core
 	}
 
 
+	Simulation::PacingMode Simulation::getPacingMode() const
+	{
+		return m_pacingMode;
+	}
+
+
+	void Simulation::setPacingMode(PacingMode value)
+	{
+		m_pacingMode = value;
+	}
+
+
+	int Simulation::getMaxCatchUpTicks() const
+	{
+		return m_maxCatchUpTicks;
+	}
+
+
+	void Simulation::setMaxCatchUpTicks(int value)
+	{
+		assert(value >= 0);
+		m_maxCatchUpTicks = std::max(0, value);
+	}
+
+
+	double Simulation::getRealTimeFactor() const
+	{
+		return m_realTimeFactor;
+	}
+
+
+	bool Simulation::getRenderSnapshotsEnabled() const
+	{
+		return m_renderSnapshotsEnabled;
+	}
+
+
+	void Simulation::setRenderSnapshotsEnabled(bool value)
+	{
+		m_renderSnapshotsEnabled = value;
+	}
+
+
+	const RenderSnapshot& Simulation::fetchRenderSnapshot()
+	{
+		m_renderSnapshots.fetch();
+		return m_renderSnapshots.getReadBuffer();
+	}
+
+
 	void Simulation::reset(uint32_t randomSeed)
 	{
 		m_randomizer->reset(randomSeed);
@@ -81,8 +166,12 @@ namespace cts { namespace core
 
 	void Simulation::step()
 	{
-		m_network.getTrafficManager().tick(*this, 1.0 / m_ticksPerSecond);
+		m_trafficManager->tick(*this, 1.0 / m_ticksPerSecond);
 		m_currentTime += 1.0 / m_ticksPerSecond;
+
+		if (m_renderSnapshotsEnabled)
+			publishRenderSnapshot();
+
 		s_stepped.emitSignal();
 	}
 
@@ -110,21 +199,94 @@ namespace cts { namespace core
 	}
 
 
+	void Simulation::publishRenderSnapshot()
+	{
+		// Only the simulation thread modifies the vehicles, hence we do not need to lock here.
+		RenderSnapshot& snapshot = m_renderSnapshots.getWriteBuffer();
+		snapshot.time = m_currentTime;
+		snapshot.vehicles.clear();
+
+		for (auto& vehicle : m_trafficManager->getVehicles())
+		{
+			const Connection* connection = vehicle->getCurrentConnection();
+			if (connection == nullptr)
+				continue;
+
+			const AbstractVehicle::State& state = vehicle->getFrozenState();
+			VehicleSnapshot::DrivingState drivingState = VehicleSnapshot::DrivingState::Driving;
+			if (state.velocity <= 0.0)
+				drivingState = VehicleSnapshot::DrivingState::Stopped;
+			else if (state.acceleration < 0.0)
+				drivingState = VehicleSnapshot::DrivingState::Braking;
+
+			const double time = connection->getCurve().arcPositionToTime(vehicle->getCurrentArcPosition());
+			snapshot.vehicles.push_back(VehicleSnapshot{
+				vehicle->debugId,
+				connection->getCurve().timeToCoordinate(time),
+				connection->getCurve().derivateAtTime(time).normalized(),
+				vehicle->getLength(),
+				drivingState
+			});
+		}
+
+		m_renderSnapshots.publish();
+	}
+
+
 	void Simulation::simulationLoop()
 	{
-		using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
-		using TimeRep = int64_t;
+		using Clock = std::chrono::steady_clock;
+		using Seconds = std::chrono::duration<double>;
+
+		// Interval for measuring the real-time factor
+		const Clock::duration measurementInterval = std::chrono::milliseconds(500);
+
+		// Steps are scheduled on absolute deadlines so that the time spent in step() as well as 
+		// inaccuracies of sleep_until() do not accumulate over time.
+		Clock::time_point deadline = Clock::now();
+		Clock::time_point measurementStart = deadline;
+		double measurementStartTime = m_currentTime;
+		m_realTimeFactor = 0.0;
+
 		while (m_currentTime < m_duration && !m_stopSimulation)
 		{
-			const TimePoint timeBefore = std::chrono::system_clock::now();
 			step();
 
-			const TimeRep microSecsBetweenSteps = static_cast<TimeRep>(1000000.0 / (m_ticksPerSecond * m_speed));
-			const TimePoint timeAfter = std::chrono::system_clock::now();
-			const TimeRep timePassed = std::chrono::duration_cast<std::chrono::microseconds>(timeAfter - timeBefore).count();
-			if (timePassed < microSecsBetweenSteps)
-				std::this_thread::sleep_for(std::chrono::microseconds(microSecsBetweenSteps - timePassed));
+			Clock::time_point now = Clock::now();
+			if (m_pacingMode == PacingMode::Unthrottled)
+			{
+				deadline = now;
+			}
+			else
+			{
+				const Clock::duration tickDuration = std::chrono::duration_cast<Clock::duration>(Seconds(1.0 / (m_ticksPerSecond * m_speed)));
+				deadline += tickDuration;
+
+				if (now < deadline)
+				{
+					std::this_thread::sleep_until(deadline);
+					now = Clock::now();
+				}
+				else if (now - deadline > tickDuration * m_maxCatchUpTicks.load())
+				{
+					// We are too far behind to catch up within a few ticks, reset the schedule instead 
+					// of running a long burst of steps back-to-back.
+					deadline = now;
+				}
+			}
+
+			if (now - measurementStart >= measurementInterval)
+			{
+				m_realTimeFactor = (m_currentTime - measurementStartTime) / std::chrono::duration_cast<Seconds>(now - measurementStart).count();
+				measurementStart = now;
+				measurementStartTime = m_currentTime;
+			}
 		}
+
+		// publish the measurement of the last (partial) interval
+		const Clock::time_point now = Clock::now();
+		if (now > measurementStart && m_currentTime > measurementStartTime)
+			m_realTimeFactor = (m_currentTime - measurementStartTime) / std::chrono::duration_cast<Seconds>(now - measurementStart).count();
 	}
 
 
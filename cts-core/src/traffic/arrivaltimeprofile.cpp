@@ -0,0 +1,45 @@
+#include <cts-core/traffic/arrivaltimeprofile.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace cts { namespace core
+{
+
+
+	ArrivalTimeProfile::ArrivalTimeProfile()
+		: m_velocity(0.0)
+		, m_desiredVelocity(0.0)
+	{
+
+	}
+
+
+	void ArrivalTimeProfile::reset(double velocity, double desiredVelocity)
+	{
+		m_velocity = velocity;
+		m_desiredVelocity = desiredVelocity;
+		m_velocities.clear();
+		m_distances.clear();
+	}
+
+
+	size_t ArrivalTimeProfile::getNumSteps() const
+	{
+		return m_distances.size();
+	}
+
+
+	double ArrivalTimeProfile::lookup(double distance) const
+	{
+		// first step ending beyond distance, the vehicle moves with constant velocity during each step
+		auto it = std::upper_bound(m_distances.begin(), m_distances.end(), distance);
+		assert(it != m_distances.end());
+
+		const size_t step = size_t(it - m_distances.begin());
+		return int(step + 1) - ((*it - distance) / m_velocities[step]);
+	}
+
+
+}
+}
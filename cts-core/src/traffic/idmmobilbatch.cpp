@@ -0,0 +1,56 @@
+#include <cts-core/traffic/vehicle.h>
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// This file holds the batch kernel of IdmMobil only, so that ENABLE_AVX2 can restrict the AVX2
+// instruction set to it instead of letting the compiler vectorize all of cts-core.
+
+namespace cts { namespace core
+{
+
+	// The vectorized kernel performs exactly the same IEEE operations as the scalar one, hence the results
+	// should be identical. The tolerance leaves room for compilers contracting the scalar code to FMAs.
+	const double IdmMobil::batchTolerance = 1e-12;
+
+
+	void IdmMobil::getAccelerations(size_t count, const double* velocities, const double* desiredVelocities, const double* distances, const double* vDiffs, double* accelerations) const
+	{
+		size_t i = 0;
+
+#if defined(__AVX2__)
+		const __m256d one = _mm256_set1_pd(1.0);
+		const __m256d maximumAcceleration = _mm256_set1_pd(m_maximumAcceleration);
+		const __m256d minimumDistance = _mm256_set1_pd(m_minimumDistance);
+		const __m256d safetyDistanceTime = _mm256_set1_pd(m_safetyDistanceTime);
+		const __m256d brakingTerm = _mm256_set1_pd(2 * sqrt(m_maximumAcceleration * m_comfortDeceleration));
+
+		for (/**/; i + 4 <= count; i += 4)
+		{
+			const __m256d velocity = _mm256_loadu_pd(velocities + i);
+			const __m256d desiredVelocity = _mm256_loadu_pd(desiredVelocities + i);
+			const __m256d distance = _mm256_loadu_pd(distances + i);
+			const __m256d vDiff = _mm256_loadu_pd(vDiffs + i);
+
+			// same order of operations as getDesiredDistance(), _mm256_max_pd(a, b) yields b if either one is NaN
+			__m256d ss = _mm256_add_pd(_mm256_add_pd(minimumDistance, _mm256_mul_pd(safetyDistanceTime, velocity)), _mm256_div_pd(_mm256_mul_pd(velocity, vDiff), brakingTerm));
+			ss = _mm256_max_pd(minimumDistance, ss);
+
+			const __m256d ratio = _mm256_div_pd(velocity, desiredVelocity);
+			const __m256d freeRoad = _mm256_sub_pd(one, _mm256_mul_pd(ratio, ratio));
+			const __m256d interaction = _mm256_sqrt_pd(_mm256_div_pd(ss, distance));
+			_mm256_storeu_pd(accelerations + i, _mm256_mul_pd(maximumAcceleration, _mm256_sub_pd(freeRoad, interaction)));
+		}
+#endif
+
+		for (/**/; i < count; ++i)
+		{
+			accelerations[i] = getAcceleration(velocities[i], desiredVelocities[i], distances[i], vDiffs[i]);
+		}
+	}
+
+}
+}
@@ -0,0 +1,158 @@
+#include <cts-core/traffic/routeplanner.h>
+#include <cts-core/base/threadpool.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehicle.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace cts { namespace core
+{
+
+	RoutePlanner::RoutePlanner(TrafficState& trafficState)
+		: m_trafficState(trafficState)
+		, m_congestionRevision(0)
+		, m_prepared(false)
+		, m_dispatched(false)
+		, m_nextRequest(0)
+		, m_numRunningTasks(0)
+	{
+
+	}
+
+
+	RoutePlanner::~RoutePlanner()
+	{
+		cancel();
+	}
+
+
+	void RoutePlanner::request(AbstractVehicle& vehicle, const Node& startNode, const std::vector<Node*>& destinationNodes)
+	{
+		assert(!m_dispatched);
+		m_requests.push_back(Request{ &vehicle, &startNode, &destinationNodes, vehicle.getTargetVelocity(), RouteStore::Query(), m_requests.size(), Routing() });
+	}
+
+
+	size_t RoutePlanner::getNumPendingRequests() const
+	{
+		return m_requests.size();
+	}
+
+
+	void RoutePlanner::dispatch(ThreadPool& threadPool)
+	{
+		if (m_dispatched || m_requests.empty())
+			return;
+		m_dispatched = true;
+
+		prepareRequests();
+		if (m_searches.empty())
+			return;
+
+		// ThreadPool::getNumThreads() includes the calling thread, which does not take part here.
+		// Without any workers, enqueue() computes all requests right away.
+		const size_t numTasks = std::max<size_t>(1, std::min(threadPool.getNumThreads() - 1, m_searches.size()));
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numRunningTasks = numTasks;
+		}
+
+		for (size_t i = 0; i < numTasks; ++i)
+		{
+			threadPool.enqueue([this]() {
+				processRequests();
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_numRunningTasks == 0)
+					m_done.notify_all();
+			});
+		}
+	}
+
+
+	void RoutePlanner::wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_numRunningTasks == 0; });
+	}
+
+
+	size_t RoutePlanner::deliver()
+	{
+		wait();
+
+		// requests that were not dispatched yet are computed on the calling thread
+		prepareRequests();
+		processRequests();
+
+		// the computed routes remain valid as long as the congestion did not change since they were requested
+		RouteStore& routeStore = m_trafficState.getRouteStore();
+		const bool cacheable = m_trafficState.getCongestionRevision() == m_congestionRevision;
+		for (size_t i = 0; i < m_requests.size(); ++i)
+		{
+			Request& request = m_requests[i];
+			if (request.source != i)
+				request.routing = m_requests[request.source].routing;
+			else if (cacheable)
+				routeStore.insert(request.query, request.routing.getRoute());
+			request.vehicle->continueRouting(request.routing);
+		}
+
+		const size_t toReturn = m_requests.size();
+		cancel();
+		return toReturn;
+	}
+
+
+	void RoutePlanner::cancel()
+	{
+		wait();
+		m_requests.clear();
+		m_searches.clear();
+		m_queries.clear();
+		m_prepared = false;
+		m_dispatched = false;
+		m_nextRequest = 0;
+	}
+
+
+	void RoutePlanner::prepareRequests()
+	{
+		if (m_prepared)
+			return;
+		m_prepared = true;
+		m_congestionRevision = m_trafficState.getCongestionRevision();
+
+		RouteStore& routeStore = m_trafficState.getRouteStore();
+		for (size_t i = 0; i < m_requests.size(); ++i)
+		{
+			Request& request = m_requests[i];
+			request.query = RouteStore::makeQuery(*request.startNode, *request.destinationNodes, request.targetVelocity);
+
+			std::shared_ptr<const Route> route = routeStore.find(request.query);
+			if (route != nullptr)
+			{
+				request.routing.setRoute(std::move(route));
+				continue;
+			}
+
+			auto it = m_queries.emplace(request.query, i).first;
+			request.source = it->second;
+			if (request.source == i)
+				m_searches.push_back(i);
+		}
+	}
+
+
+	void RoutePlanner::processRequests()
+	{
+		// each request is computed exactly once and only written by the thread computing it
+		for (size_t i = m_nextRequest++; i < m_searches.size(); i = m_nextRequest++)
+		{
+			Request& request = m_requests[m_searches[i]];
+			request.routing.compute(*request.startNode, *request.destinationNodes, m_trafficState, request.targetVelocity);
+		}
+	}
+
+}
+}
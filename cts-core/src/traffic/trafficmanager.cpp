@@ -1,10 +1,14 @@
 #include <cts-core/base/log.h>
+#include <cts-core/base/threadpool.h>
 #include <cts-core/network/connection.h>
+#include <cts-core/network/network.h>
 #include <cts-core/network/node.h>
 #include <cts-core/network/routing.h>
 #include <cts-core/simulation/randomizer.h>
 #include <cts-core/simulation/simulation.h>
+#include <cts-core/traffic/routeplanner.h>
 #include <cts-core/traffic/trafficmanager.h>
+#include <cts-core/traffic/trafficstate.h>
 #include <cts-core/traffic/vehicle.h>
 
 #include <algorithm>
@@ -14,63 +18,143 @@ namespace cts { namespace core
 {
 
 
-	TrafficManager::TrafficVolume::TrafficVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination)
-		: start(start, "")
-		, destination(destination, "")
-		, carsPerHour(0)
-		, trucksPerHour(0)
-		, busesPerHour(0)
-		, tramsPerHour(0)
+	TrafficManager::TrafficManager(const Network& network, TrafficState& trafficState)
+		: m_network(network)
+		, m_trafficState(trafficState)
+		, m_globalTrafficMultiplier(1.2)
+		, m_routeRepairThreshold(AbstractVehicle::defaultRouteRepairThreshold)
+		, m_asyncRouting(false)
+		, m_statistics{ 0, 0, 0.0, 0.0, 0, 0, 0 }
+		, m_routePlanner(new RoutePlanner(trafficState))
+		, m_threadPool(new ThreadPool(1))
 	{
+		registerVehicleType<IdmMobil>(VehicleType::Car, 42);
+	}
+
 
+	TrafficManager::~TrafficManager()
+	{
+		clearVehicles();
 	}
 
 
-	// ================================================================================================
+	double TrafficManager::getGlobalTrafficMultiplier() const
+	{
+		return m_globalTrafficMultiplier;
+	}
 
 
-	TrafficManager::TrafficManager()
-		: m_globalTrafficMultiplier(1.2)
-	{}
+	void TrafficManager::setGlobalTrafficMultiplier(double value)
+	{
+		m_globalTrafficMultiplier = value;
+	}
 
 
-	TrafficManager::~TrafficManager() {}
+	size_t TrafficManager::getNumThreads() const
+	{
+		return m_threadPool->getNumThreads();
+	}
 
 
-	double TrafficManager::getGlobalTrafficMultiplier() const
+	void TrafficManager::setNumThreads(size_t value)
 	{
-		return m_globalTrafficMultiplier;
+		// dispatched route requests might still be running on the old workers
+		m_routePlanner->wait();
+		m_threadPool = std::make_unique<ThreadPool>(value);
 	}
 
 
-	void TrafficManager::setGlobalTrafficMultiplier(double value)
+	double TrafficManager::getRouteRepairThreshold() const
 	{
-		m_globalTrafficMultiplier = value;
+		return m_routeRepairThreshold;
 	}
 
 
-	void TrafficManager::clearVehicles()
+	void TrafficManager::setRouteRepairThreshold(double value)
 	{
-		m_vehicles.clear();
+		m_routeRepairThreshold = value;
 	}
 
 
-	TrafficManager::TrafficVolume* TrafficManager::addVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination)
+	double TrafficManager::getRouteTreeInterval() const
 	{
-		m_volumes.push_back(std::make_unique<TrafficVolume>(start, destination));
-		return m_volumes.back().get();
+		return m_trafficState.getRouteTrees().getRefreshInterval();
 	}
 
 
-	void TrafficManager::removeVolume(TrafficVolume* volume)
+	void TrafficManager::setRouteTreeInterval(double value)
 	{
-		utils::remove_erase_unique_ptr(m_volumes, volume);
+		m_trafficState.getRouteTrees().setRefreshInterval(value);
 	}
 
 
-	const std::vector< std::unique_ptr<TrafficManager::TrafficVolume> >& TrafficManager::getVolumes() const
+	double TrafficManager::getCostSnapshotInterval() const
 	{
-		return m_volumes;
+		return m_trafficState.getCostSnapshotInterval();
+	}
+
+
+	void TrafficManager::setCostSnapshotInterval(double value)
+	{
+		// dispatched route requests might still be reading the snapshot
+		m_routePlanner->wait();
+		m_trafficState.setCostSnapshotInterval(value);
+	}
+
+
+	bool TrafficManager::isAsyncRouting() const
+	{
+		return m_asyncRouting;
+	}
+
+
+	void TrafficManager::setAsyncRouting(bool value)
+	{
+		m_asyncRouting = value;
+	}
+
+
+	bool TrafficManager::unregisterVehicleType(VehicleType type)
+	{
+		if (!canChangeVehicleTypes())
+			return false;
+
+		m_batches[size_t(type)].reset();
+		utils::remove_erase_if(m_vehiclesToSpawn, [type](const PendingVehicle& pending) { return pending.type == type; });
+		return true;
+	}
+
+
+	bool TrafficManager::isVehicleTypeRegistered(VehicleType type) const
+	{
+		return m_batches[size_t(type)] != nullptr;
+	}
+
+
+	void TrafficManager::clearVehicles()
+	{
+		m_routePlanner->cancel();
+		for (auto& batch : m_batches)
+		{
+			if (batch != nullptr)
+				batch->clear();
+		}
+		m_vehicles.clear();
+		m_vehiclesToSpawn.clear();
+		m_trafficState.getVehicleStore().compact();
+		m_trafficState.clear();
+	}
+
+
+	const TrafficManager::Statistics& TrafficManager::getStatistics() const
+	{
+		return m_statistics;
+	}
+
+
+	void TrafficManager::resetStatistics()
+	{
+		m_statistics = Statistics{ 0, 0, 0.0, 0.0, 0, 0, 0 };
 	}
 
 
@@ -84,6 +168,12 @@ namespace cts { namespace core
 	{
 		{
 			std::lock_guard<std::mutex> lockGuard(simulation.getMutex());
+			// routes requested during the last tick are delivered before anything else touches the vehicles
+			m_statistics.numRouteComputations += m_routePlanner->deliver();
+			// connections or intersections might have been added to the network in the meantime
+			m_trafficState.resize();
+			m_trafficState.updateCostSnapshot(simulation.getCurrentTime());
+			m_trafficState.getRouteTrees().update(simulation.getCurrentTime());
 			spawnVehicles(simulation, tickLength);
 			tickVehicles(simulation, tickLength);
 		}
@@ -92,7 +182,22 @@ namespace cts { namespace core
 			// clean up vehicles that reached their destination
 			std::lock_guard<std::mutex> lockGuard(simulation.getMutex());
 			const auto vc = m_vehicles.size();
+			for (auto& v : m_vehicles)
+			{
+				if (v->hasArrived())
+				{
+					++m_statistics.numArrivedVehicles;
+					m_statistics.totalTravelTime += simulation.getCurrentTime() + tickLength - v->getSpawnTime();
+					m_statistics.totalTravelDistance += v->getTravelledDistance();
+				}
+			}
+			for (auto& batch : m_batches)
+			{
+				if (batch != nullptr)
+					batch->removeArrivedVehicles();
+			}
 			utils::remove_erase_if(m_vehicles, [](const std::unique_ptr<AbstractVehicle>& v) { return v->getCurrentConnection() == nullptr; });
+			m_trafficState.getVehicleStore().compact();
 			const auto vc2 = m_vehicles.size();
 			if (vc2 < vc)
 				LOG_DEBUG("core.TrafficManager", "Removed " << (vc - vc2) << " vehicles.");
@@ -100,30 +205,49 @@ namespace cts { namespace core
 	}
 
 
+	bool TrafficManager::canChangeVehicleTypes() const
+	{
+		if (!m_vehicles.empty())
+		{
+			LOG_WARN("core.TrafficManager", "Cannot change the vehicle types while there are vehicles.");
+			return false;
+		}
+		return true;
+	}
+
+
 	void TrafficManager::spawnVehicles(const Simulation& simulation, double tickLength)
 	{
 		const double time = tickLength * m_globalTrafficMultiplier;
 		if (time <= 0.0)
 			return;
 
-		for (auto& volume : m_volumes)
+		for (auto& volume : m_network.getVolumes())
 		{
-			if (volume->carsPerHour <= 0 || volume->start.getNodes().empty() || volume->destination.getNodes().empty())
+			if (volume->start.getNodes().empty() || volume->destination.getNodes().empty())
 				continue;
 
-			const uint32_t randomCar = simulation.getRandomizer().nextInt(int(ceil(3600.0 / (time * volume->carsPerHour))));
-			if (randomCar == 0)
+			for (size_t type = 0; type < numVehicleTypes; ++type)
 			{
-				// Since the place where the vehicle should spawn might be occupied at this very moment, 
-				// spawning vehicles is a two-step process: Here, we just add the TrafficVolume to the list 
-				// of vehicles-to-spawn. Below, we then try to spawn all vehicles and only if the spawning 
-				// was successful, we remove it from m_vehiclesToSpawn.
-				m_vehiclesToSpawn.emplace_back(volume.get());
+				const int vehiclesPerHour = volume->getVehiclesPerHour(VehicleType(type));
+				if (vehiclesPerHour <= 0 || m_batches[type] == nullptr)
+					continue;
+
+				const uint32_t randomVehicle = simulation.getRandomizer().nextInt(int(ceil(3600.0 / (time * vehiclesPerHour))));
+				if (randomVehicle == 0)
+				{
+					// Since the place where the vehicle should spawn might be occupied at this very moment, 
+					// spawning vehicles is a two-step process: Here, we just add the TrafficVolume to the list 
+					// of vehicles-to-spawn. Below, we then try to spawn all vehicles and only if the spawning 
+					// was successful, we remove it from m_vehiclesToSpawn.
+					m_vehiclesToSpawn.push_back(PendingVehicle{ volume.get(), VehicleType(type) });
+				}
 			}
 		}
 
-		for (auto& volume : m_vehiclesToSpawn)
+		for (auto& pending : m_vehiclesToSpawn)
 		{
+			const TrafficVolume* volume = pending.volume;
 			const uint32_t startIndex = simulation.getRandomizer().nextInt(uint32_t(volume->start.getNodes().size()));
 			const Node* start = volume->start.getNodes()[startIndex];
 
@@ -131,9 +255,10 @@ namespace cts { namespace core
 			bool canSpawn = true;
 			for (auto& connection : start->getOutgoingConnections())
 			{
-				if (!connection->getVehicles().empty())
+				const auto& vehicles = m_trafficState.getVehicles(*connection);
+				if (!vehicles.empty())
 				{
-					const AbstractVehicle* v = connection->getVehicles().front();
+					const AbstractVehicle* v = vehicles.front();
 					if (v->getCurrentArcPosition() < v->getLength() + 20.0) // FIXME: ugly constant hack
 					{
 						canSpawn = false;
@@ -144,35 +269,75 @@ namespace cts { namespace core
 
 			if (canSpawn)
 			{
-				m_vehicles.push_back(std::make_unique< TypedVehicle<IdmMobil> >(*start, volume->destination.getNodes(), 42));
+				m_vehicles.push_back(m_batches[size_t(pending.type)]->createVehicle(m_trafficState, *start, volume->destination.getNodes()));
 				AbstractVehicle* v = m_vehicles.back().get();
 				v->setCurrentArcPosition(0.0);
+				v->setSpawnTime(simulation.getCurrentTime());
+				v->setRouteRepairThreshold(m_routeRepairThreshold);
+				v->setRoutePlanner(m_asyncRouting ? m_routePlanner.get() : nullptr);
+				++m_statistics.numSpawnedVehicles;
+				m_statistics.numRouteComputations += v->getNumRouteComputations();
 				s_vehicleSpawned.emitSignal(v);
-				volume = nullptr;
+				pending.volume = nullptr;
 			}
 		}
 
 		// remove all vehicles that were spawned successfully from the list.
-		utils::remove_erase(m_vehiclesToSpawn, nullptr);
+		utils::remove_erase_if(m_vehiclesToSpawn, [](const PendingVehicle& pending) { return pending.volume == nullptr; });
 	}
 	
 
 	void TrafficManager::tickVehicles(const Simulation& simulation, double tickLength)
 	{
-		for (auto& vehicle : m_vehicles)
+		VehicleStore& store = m_trafficState.getVehicleStore();
+
+		for (size_t i = 0; i < store.size(); ++i)
 		{
-			vehicle->prepare(simulation.getCurrentTime());
+			AbstractVehicle* v = store.getVehicle(i);
+			const size_t numOverflows = v->getNumRegistrationOverflows();
+			v->prepare(simulation.getCurrentTime());
+			m_statistics.numRegistrationOverflows += v->getNumRegistrationOverflows() - numOverflows;
 		}
+		m_trafficState.updateBlockingIndices();
+		store.freeze();
+		m_trafficState.updateLeaders(AbstractVehicle::getLookaheadDistance());
 
-		for (auto& vehicle : m_vehicles)
+		// During the think phase, vehicles only write their own state and only read the frozen state 
+		// of other vehicles. Hence, we can process them concurrently and still get deterministic results.
+		for (auto& batch : m_batches)
 		{
-			vehicle->think();
+			if (batch == nullptr)
+				continue;
+
+			AbstractVehicleBatch& b = *batch;
+			m_threadPool->parallelFor(b.size(), [&b](size_t begin, size_t end) {
+				b.think(begin, end);
+			});
 		}
 
-		for (auto& vehicle : m_vehicles)
+		m_threadPool->parallelFor(store.size(), [&store](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				store.getVehicle(i)->publishDecisions();
+		});
+
+		// Move all vehicles in a single pass over the store, only vehicles leaving their current 
+		// connection need to touch their route.
+		m_leavingVehicles.clear();
+		store.move(tickLength, m_leavingVehicles);
+		m_trafficState.sortVehicles();
+		for (size_t i : m_leavingVehicles)
 		{
-			vehicle->move(tickLength);
+			AbstractVehicle* v = store.getVehicle(i);
+			const size_t numRouteComputations = v->getNumRouteComputations();
+			const size_t numRouteRepairs = v->getNumRouteRepairs();
+			v->leaveConnection();
+			m_statistics.numRouteComputations += v->getNumRouteComputations() - numRouteComputations;
+			m_statistics.numRouteRepairs += v->getNumRouteRepairs() - numRouteRepairs;
 		}
+
+		// The requested routes are computed while the tick is finished, the traffic state does not change until
+		// they are delivered at the beginning of the next tick.
+		m_routePlanner->dispatch(*m_threadPool);
 	}
 
 
@@ -0,0 +1,555 @@
+#include <cts-core/base/log.h>
+#include <cts-core/network/connection.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+#include <cts-core/network/routing.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehicle.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
+
+namespace cts { namespace core
+{
+
+
+	TrafficState::TrafficState(const Network& network)
+		: m_network(network)
+		, m_routeTrees(*this)
+		, m_landmarks(*this)
+		, m_routeStore(*this)
+		, m_congestionRevision(0)
+		, m_topologyRevision(network.getTopologyRevision())
+		, m_costSnapshotInterval(0.0)
+		, m_lastCostSnapshotTime(0.0)
+	{
+		remapConnections();
+		resize();
+	}
+
+
+	const Network& TrafficState::getNetwork() const
+	{
+		return m_network;
+	}
+
+
+	void TrafficState::resize()
+	{
+		const bool topologyChanged = (m_topologyRevision != m_network.getTopologyRevision());
+		if (topologyChanged)
+			remapConnections();
+		m_intersections.resize(m_network.getIntersections().size());
+
+		// cached routes might use removed connections or miss new ones
+		const bool landmarksChanged = m_landmarks.update();
+		if (landmarksChanged || topologyChanged)
+		{
+			m_topologyRevision = m_network.getTopologyRevision();
+			++m_congestionRevision;
+			if (isCostSnapshotEnabled())
+				refreshCostSnapshot();
+		}
+	}
+
+
+	void TrafficState::clear()
+	{
+		for (auto& vehicles : m_connections)
+			vehicles.clear();
+		for (auto& is : m_intersections)
+		{
+			is.aCrossingVehicles = CrossingVehicles();
+			is.bCrossingVehicles = CrossingVehicles();
+		}
+		m_routeTrees.invalidate();
+		m_routeStore.clear();
+		if (isCostSnapshotEnabled())
+			refreshCostSnapshot();
+		++m_congestionRevision;
+	}
+
+
+	VehicleStore& TrafficState::getVehicleStore()
+	{
+		return m_vehicleStore;
+	}
+
+
+	const VehicleStore& TrafficState::getVehicleStore() const
+	{
+		return m_vehicleStore;
+	}
+
+
+	RouteTreeCache& TrafficState::getRouteTrees()
+	{
+		return m_routeTrees;
+	}
+
+
+	const RouteTreeCache& TrafficState::getRouteTrees() const
+	{
+		return m_routeTrees;
+	}
+
+
+	Landmarks& TrafficState::getLandmarks()
+	{
+		return m_landmarks;
+	}
+
+
+	const Landmarks& TrafficState::getLandmarks() const
+	{
+		return m_landmarks;
+	}
+
+
+	RouteStore& TrafficState::getRouteStore()
+	{
+		return m_routeStore;
+	}
+
+
+	const RouteStore& TrafficState::getRouteStore() const
+	{
+		return m_routeStore;
+	}
+
+
+	size_t TrafficState::getCongestionRevision() const
+	{
+		return m_congestionRevision;
+	}
+
+
+	bool TrafficState::isCostSnapshotEnabled() const
+	{
+		return m_costSnapshotInterval > 0.0;
+	}
+
+
+	double TrafficState::getCostSnapshotInterval() const
+	{
+		return m_costSnapshotInterval;
+	}
+
+
+	void TrafficState::setCostSnapshotInterval(double value)
+	{
+		m_costSnapshotInterval = std::max(0.0, value);
+		if (isCostSnapshotEnabled())
+			refreshCostSnapshot();
+		else
+			m_costSnapshot.clear();
+		++m_congestionRevision;
+	}
+
+
+	void TrafficState::updateCostSnapshot(double currentTime)
+	{
+		if (!isCostSnapshotEnabled())
+			return;
+
+		// the simulation might have been reset in the meantime
+		if (currentTime < m_lastCostSnapshotTime || currentTime >= m_lastCostSnapshotTime + m_costSnapshotInterval)
+		{
+			refreshCostSnapshot();
+			m_lastCostSnapshotTime = currentTime;
+		}
+	}
+
+
+	void TrafficState::refreshCostSnapshot()
+	{
+		m_costSnapshot.resize(m_network.getNumConnections());
+		for (auto& node : m_network.getNodes())
+		{
+			for (const Connection* connection : node->getOutgoingConnections())
+				m_costSnapshot[connection->getIndex()] = Routing::computeCongestedArcLength(*connection, getVehicles(*connection).size());
+		}
+		++m_congestionRevision;
+	}
+
+
+	double TrafficState::getCongestedArcLength(const Connection& connection) const
+	{
+		if (isCostSnapshotEnabled())
+		{
+			assert(connection.getIndex() < m_costSnapshot.size());
+			return m_costSnapshot[connection.getIndex()];
+		}
+		return Routing::computeCongestedArcLength(connection, getVehicles(connection).size());
+	}
+
+
+	const TrafficState::VehicleListType& TrafficState::getVehicles(const Connection& connection) const
+	{
+		assert(connection.getIndex() < m_connections.size());
+		return m_connections[connection.getIndex()];
+	}
+
+
+	void TrafficState::addVehicle(const Connection& connection, AbstractVehicle* vehicle, double arcPosition)
+	{
+		assert(connection.getIndex() < m_connections.size());
+		auto& vehicles = m_connections[connection.getIndex()];
+		assert(std::find(vehicles.begin(), vehicles.end(), vehicle) == vehicles.end());
+
+		auto it = vehicleIteratorBehind(vehicles, arcPosition);
+		vehicles.insert(it, vehicle);
+		if (!isCostSnapshotEnabled())
+			++m_congestionRevision;
+	}
+
+
+	void TrafficState::removeVehicle(const Connection& connection, AbstractVehicle* vehicle)
+	{
+		assert(connection.getIndex() < m_connections.size());
+		auto& vehicles = m_connections[connection.getIndex()];
+
+		auto rit = std::find(vehicles.rbegin(), vehicles.rend(), vehicle);
+		if (rit != vehicles.rend())
+		{
+			vehicles.erase(std::next(rit).base());
+			if (!isCostSnapshotEnabled())
+				++m_congestionRevision;
+		}
+	}
+
+
+	void TrafficState::sortVehicles()
+	{
+		for (auto& vehicles : m_connections)
+		{
+			// insertion sort, which is stable and linear for the almost sorted lists we have here
+			for (size_t i = 1; i < vehicles.size(); ++i)
+			{
+				AbstractVehicle* v = vehicles[i];
+				const double arcPosition = v->getCurrentArcPosition();
+
+				size_t j = i;
+				for (; j > 0 && arcPosition < vehicles[j - 1]->getCurrentArcPosition(); --j)
+					vehicles[j] = vehicles[j - 1];
+				vehicles[j] = v;
+			}
+		}
+	}
+
+
+	void TrafficState::updateLeaders(double lookaheadDistance)
+	{
+		auto& columns = m_vehicleStore.getColumns();
+
+		for (auto& vehicles : m_connections)
+		{
+			// walk from the front to the back so that the leader is always at hand
+			AbstractVehicle* leader = nullptr;
+			double leaderArcPosition = 0.0;
+			for (size_t j = vehicles.size(); j-- > 0; )
+			{
+				const AbstractVehicle* v = vehicles[j];
+				const size_t index = m_vehicleStore.getIndex(v->getVehicleId());
+				const double arcPosition = columns.arcPositions[index];
+
+				// vehicles at the very same position do not lead each other
+				if (j + 1 < vehicles.size() && vehicles[j + 1]->getCurrentArcPosition() > arcPosition)
+				{
+					leader = vehicles[j + 1];
+					leaderArcPosition = leader->getCurrentArcPosition();
+				}
+
+				if (leader != nullptr)
+				{
+					columns.leaders[index] = leader;
+					columns.leaderDistances[index] = leaderArcPosition - arcPosition;
+				}
+				else
+				{
+					const VehicleDistance vd = getVehicleOnRoute(*v, arcPosition, lookaheadDistance);
+					columns.leaders[index] = vd.vehicle;
+					columns.leaderDistances[index] = vd.distance;
+				}
+			}
+		}
+	}
+
+
+	VehicleDistance TrafficState::getVehicleBehind(const Connection& connection, double arcPosition, double searchDistance) const
+	{
+		// check whether there is a vehicle on this connection
+		const auto& vehicles = getVehicles(connection);
+		auto it = vehicleIteratorBehind(vehicles, arcPosition);
+		if (it != vehicles.end())
+		{
+			return VehicleDistance(*it, (*it)->getCurrentArcPosition() - arcPosition);
+		}
+		// if not, check the following connections recursively
+		else
+		{
+			const double remainingDistance = searchDistance - (connection.getCurve().getArcLength() - arcPosition);
+			if (remainingDistance <= 0.0)
+			{
+				return VehicleDistance();
+			}
+			else
+			{
+				VehicleDistance toReturn = utils::reduce(connection.getEndNode().getOutgoingConnections(), VehicleDistance(), [this, remainingDistance](VehicleDistance lhs, Connection* c) {
+					return VehicleDistance::min(lhs, getVehicleBehind(*c, 0, remainingDistance));
+				});
+				toReturn.distance += connection.getCurve().getArcLength() - arcPosition;
+				return toReturn;
+			}
+		}
+	}
+
+
+	VehicleDistance TrafficState::getVehicleBefore(const Connection& connection, double arcPosition, double searchDistance) const
+	{
+		// check whether there is a vehicle on this connection
+		const auto& vehicles = getVehicles(connection);
+		auto it = vehicleIteratorBefore(vehicles, arcPosition);
+		if (it != vehicles.end())
+		{
+			return VehicleDistance(*it, arcPosition - (*it)->getCurrentArcPosition());
+		}
+		// if not, check the following connections recursively
+		else
+		{
+			const double remainingDistance = searchDistance - arcPosition;
+			if (remainingDistance <= 0.0)
+			{
+				return VehicleDistance();
+			}
+			else
+			{
+				VehicleDistance toReturn = utils::reduce(connection.getStartNode().getIncomingConnections(), VehicleDistance(), [this, remainingDistance](VehicleDistance lhs, Connection* c) {
+					return VehicleDistance::min(lhs, getVehicleBefore(*c, 0, remainingDistance));
+				});
+				toReturn.distance += arcPosition;
+				return toReturn;
+			}
+		}
+	}
+
+
+	const TrafficState::IntersectionState& TrafficState::getIntersectionState(const Intersection& intersection) const
+	{
+		assert(intersection.getIndex() < m_intersections.size());
+		return m_intersections[intersection.getIndex()];
+	}
+
+
+	TrafficState::RegistrationHandle TrafficState::registerVehicle(const Intersection& intersection, const AbstractVehicle& vehicle, const Connection& connection, double remainingDistance, vec2 blockingTime)
+	{
+		auto& cv = getCrossingVehicles(intersection, connection);
+		cv.blockingIndexOutdated = true;
+		const Registration registration{ &vehicle, Intersection::CrossingVehicleInfo{ blockingTime[0], remainingDistance, blockingTime, false, false } };
+
+		if (cv.freeSlots.empty())
+		{
+			cv.slots.push_back(registration);
+			return RegistrationHandle(cv.slots.size() - 1);
+		}
+
+		const RegistrationHandle handle = cv.freeSlots.back();
+		cv.freeSlots.pop_back();
+		cv.slots[handle] = registration;
+		return handle;
+	}
+
+
+	void TrafficState::updateVehicle(const Intersection& intersection, const Connection& connection, RegistrationHandle handle, double remainingDistance, vec2 blockingTime)
+	{
+		getCrossingVehicles(intersection, connection).blockingIndexOutdated = true;
+		auto& info = getRegistration(intersection, connection, handle).info;
+
+		// The published waiting status is kept until the vehicle has made its next decision.
+		info.remainingDistance = remainingDistance;
+		info.blockingTime = blockingTime;
+		info.pendingWaitInFront = false;
+	}
+
+
+	void TrafficState::updateVehicleWait(const Intersection& intersection, const Connection& connection, RegistrationHandle handle, bool willWaitInFront)
+	{
+		getRegistration(intersection, connection, handle).info.pendingWaitInFront = willWaitInFront;
+	}
+
+
+	void TrafficState::publishVehicleWait(const Intersection& intersection, const Connection& connection, RegistrationHandle handle)
+	{
+		auto& info = getRegistration(intersection, connection, handle).info;
+		info.willWaitInFront = info.pendingWaitInFront;
+	}
+
+
+	void TrafficState::unregisterVehicle(const Intersection& intersection, const Connection& connection, RegistrationHandle handle)
+	{
+		auto& cv = getCrossingVehicles(intersection, connection);
+		if (handle < cv.slots.size() && cv.slots[handle].vehicle != nullptr)
+		{
+			cv.slots[handle].vehicle = nullptr;
+			cv.freeSlots.push_back(handle);
+			cv.blockingIndexOutdated = true;
+		}
+		else
+		{
+			LOG_WARN("TrafficState", "Trying to unregister unknown vehicle.");
+		}
+	}
+
+
+	void TrafficState::updateBlockingIndices()
+	{
+		for (auto& is : m_intersections)
+		{
+			for (CrossingVehicles* cv : { &is.aCrossingVehicles, &is.bCrossingVehicles })
+			{
+				if (!cv->blockingIndexOutdated)
+					continue;
+
+				auto& index = cv->blockingIndex;
+				index.clear();
+				for (RegistrationHandle h = 0; h < cv->slots.size(); ++h)
+				{
+					const Registration& r = cv->slots[h];
+					if (r.vehicle != nullptr)
+						index.push_back(CrossingVehicles::BlockingInterval{ r.info.blockingTime[0], r.info.blockingTime[1], 0.0, h });
+				}
+
+				// sort by handle on ties to stay independent of the sort implementation
+				std::sort(index.begin(), index.end(), [](const CrossingVehicles::BlockingInterval& lhs, const CrossingVehicles::BlockingInterval& rhs) {
+					return lhs.begin < rhs.begin || (lhs.begin == rhs.begin && lhs.handle < rhs.handle);
+				});
+
+				double maxEnd = -std::numeric_limits<double>::infinity();
+				for (auto& bi : index)
+				{
+					maxEnd = std::max(maxEnd, bi.end);
+					bi.maxEnd = maxEnd;
+				}
+
+				cv->blockingIndexOutdated = false;
+			}
+		}
+	}
+
+
+	const Intersection::CrossingVehicleInfo& TrafficState::getCrossingVehicleInfo(const Intersection& intersection, const Connection& connection, RegistrationHandle handle) const
+	{
+		const auto& cv = getCrossingVehicles(intersection, connection);
+		assert(handle < cv.slots.size() && cv.slots[handle].vehicle != nullptr);
+		return cv.slots[handle].info;
+	}
+
+
+	void TrafficState::remapConnections()
+	{
+		std::unordered_map<const Connection*, size_t> oldIndices;
+		for (size_t i = 0; i < m_connectionKeys.size(); ++i)
+			oldIndices.emplace(m_connectionKeys[i], i);
+
+		std::vector<VehicleListType> connections(m_network.getNumConnections());
+		m_connectionKeys.assign(m_network.getNumConnections(), nullptr);
+		auto& columns = m_vehicleStore.getColumns();
+		for (const Connection& connection : m_network.getConnections())
+		{
+			const size_t index = connection.getIndex();
+			m_connectionKeys[index] = &connection;
+
+			auto it = oldIndices.find(&connection);
+			if (it == oldIndices.end())
+				continue;
+
+			connections[index] = std::move(m_connections[it->second]);
+			if (it->second != index)
+			{
+				// the vehicles store the index of their connection as well
+				for (const AbstractVehicle* v : connections[index])
+					columns.connectionIndices[m_vehicleStore.getIndex(v->getVehicleId())] = uint32_t(index);
+			}
+		}
+		m_connections = std::move(connections);
+	}
+
+
+	VehicleDistance TrafficState::getVehicleOnRoute(const AbstractVehicle& vehicle, double arcPosition, double searchDistance) const
+	{
+		const auto& segments = vehicle.getRouting().getSegments();
+		if (segments.empty())
+			return VehicleDistance();
+
+		// the first segment is the current connection of the vehicle
+		double distance = segments[0].connection->getCurve().getArcLength() - arcPosition;
+		for (size_t i = 1; i < segments.size() && distance < searchDistance; ++i)
+		{
+			const auto& vehicles = getVehicles(*segments[i].connection);
+			auto it = vehicleIteratorBehind(vehicles, 0.0);
+			if (it != vehicles.end())
+				return VehicleDistance(*it, distance + (*it)->getCurrentArcPosition());
+
+			distance += segments[i].connection->getCurve().getArcLength();
+		}
+
+		return VehicleDistance();
+	}
+
+
+	TrafficState::VehicleListType::const_iterator TrafficState::vehicleIteratorBehind(const VehicleListType& vehicles, double arcPosition) const
+	{
+		return std::upper_bound(vehicles.cbegin(), vehicles.cend(), arcPosition, [](double position, const AbstractVehicle* v) { return position < v->getCurrentArcPosition(); });
+	}
+
+
+	TrafficState::VehicleListType::const_iterator TrafficState::vehicleIteratorBefore(const VehicleListType& vehicles, double arcPosition) const
+	{
+		auto it = std::lower_bound(vehicles.cbegin(), vehicles.cend(), arcPosition, [](const AbstractVehicle* v, double position) { return v->getCurrentArcPosition() < position; });
+		if (it == vehicles.cbegin())
+			return vehicles.cend();
+		else
+			return it - 1;
+	}
+
+
+	bool TrafficState::canInterfere(const Intersection& intersection)
+	{
+		const Connection& aConnection = intersection.getFirstConnection();
+		const Connection& bConnection = intersection.getSecondConnection();
+		const double waitingDistance = intersection.getWaitingDistance();
+		return &aConnection.getStartNode() != &bConnection.getEndNode() || (waitingDistance < intersection.getFirstArcPosition() && waitingDistance < intersection.getSecondArcPosition());
+	}
+
+
+	TrafficState::Registration& TrafficState::getRegistration(const Intersection& intersection, const Connection& connection, RegistrationHandle handle)
+	{
+		auto& cv = getCrossingVehicles(intersection, connection);
+		assert(handle < cv.slots.size() && cv.slots[handle].vehicle != nullptr);
+		return cv.slots[handle];
+	}
+
+
+	TrafficState::CrossingVehicles& TrafficState::getCrossingVehicles(const Intersection& intersection, const Connection& connection)
+	{
+		assert(intersection.getIndex() < m_intersections.size());
+		assert(&connection == &intersection.getFirstConnection() || &connection == &intersection.getSecondConnection());
+		auto& is = m_intersections[intersection.getIndex()];
+		return (&connection == &intersection.getFirstConnection()) ? is.aCrossingVehicles : is.bCrossingVehicles;
+	}
+
+
+	const TrafficState::CrossingVehicles& TrafficState::getCrossingVehicles(const Intersection& intersection, const Connection& connection) const
+	{
+		assert(intersection.getIndex() < m_intersections.size());
+		assert(&connection == &intersection.getFirstConnection() || &connection == &intersection.getSecondConnection());
+		const auto& is = m_intersections[intersection.getIndex()];
+		return (&connection == &intersection.getFirstConnection()) ? is.aCrossingVehicles : is.bCrossingVehicles;
+	}
+
+
+}
+}
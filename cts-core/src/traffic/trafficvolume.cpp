@@ -0,0 +1,37 @@
+#include <cts-core/traffic/trafficvolume.h>
+
+namespace cts { namespace core
+{
+
+
+	TrafficVolume::TrafficVolume(const std::vector<Node*>& start, const std::vector<Node*>& destination)
+		: start(start, "")
+		, destination(destination, "")
+		, carsPerHour(0)
+		, trucksPerHour(0)
+		, busesPerHour(0)
+		, tramsPerHour(0)
+	{
+
+	}
+
+
+	int TrafficVolume::getVehiclesPerHour(VehicleType type) const
+	{
+		switch (type)
+		{
+		case VehicleType::Car:
+			return carsPerHour;
+		case VehicleType::Truck:
+			return trucksPerHour;
+		case VehicleType::Bus:
+			return busesPerHour;
+		case VehicleType::Tram:
+			return tramsPerHour;
+		}
+		return 0;
+	}
+
+
+}
+}
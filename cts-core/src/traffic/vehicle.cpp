@@ -1,8 +1,11 @@
 #include <cts-core/base/utils.h>
 #include <cts-core/network/connection.h>
+#include <cts-core/traffic/routeplanner.h>
+#include <cts-core/traffic/trafficstate.h>
 #include <cts-core/traffic/vehicle.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 namespace cts { namespace core
@@ -31,14 +34,16 @@ namespace cts { namespace core
 
 	double IdmMobil::getAcceleration(double velocity, double desiredVelocity) const
 	{
-		return m_maximumAcceleration * (1.0 - pow(velocity / desiredVelocity, 2.0));
+		const double ratio = velocity / desiredVelocity;
+		return m_maximumAcceleration * (1.0 - ratio * ratio);
 	}
 
 
 	double IdmMobil::getAcceleration(double velocity, double desiredVelocity, double distance, double vDiff) const
 	{
 		double ss = getDesiredDistance(velocity, vDiff);
-		return m_maximumAcceleration * (1.0 - pow(velocity / desiredVelocity, 2.0) - sqrt(ss / distance));
+		const double ratio = velocity / desiredVelocity;
+		return m_maximumAcceleration * (1.0 - ratio * ratio - sqrt(ss / distance));
 	}
 
 
@@ -46,20 +51,28 @@ namespace cts { namespace core
 
 
 	const double AbstractVehicle::m_lookaheadDistance = 768.0;
+	const size_t AbstractVehicle::registrationWindowCapacity = 16;
+	const double AbstractVehicle::defaultRouteRepairThreshold = 0.1;
 
 
-	AbstractVehicle::AbstractVehicle(const Node& start, const std::vector<Node*> destination, double targetVelocity)
-		: m_targetVelocity(targetVelocity)
+	AbstractVehicle::AbstractVehicle(TrafficState& trafficState, const Node& start, const std::vector<Node*> destination, double targetVelocity)
+		: m_trafficState(trafficState)
+		, m_id(trafficState.getVehicleStore().add(this, targetVelocity, targetVelocity))
 		, m_multiplierTargetVelocity(1.0)
-		, m_acceleration(0.0)
-		, m_velocity(targetVelocity)
 		, m_routing()
 		, m_currentConnection(nullptr)
 		, m_destinationNodes(destination)
-		, m_currentArcPosition(0.0)
 		, m_length(40)
+		, m_spawnTime(0.0)
+		, m_arrived(false)
+		, m_registeredIntersections(registrationWindowCapacity)
+		, m_routeRepairThreshold(defaultRouteRepairThreshold)
+		, m_routePlanner(nullptr)
+		, m_numRouteComputations(0)
+		, m_numRouteRepairs(0)
 	{
-		static int counter = 0;
+		// vehicles of different simulations may be created concurrently
+		static std::atomic<int> counter(0);
 		debugId = ++counter;
 
 		// FIXME: *this not fully constructed?!
@@ -73,15 +86,88 @@ namespace cts { namespace core
 	}
 
 
+	AbstractVehicle::~AbstractVehicle()
+	{
+		m_trafficState.getVehicleStore().remove(m_id);
+	}
+
+
 	double AbstractVehicle::getTargetVelocity() const
 	{
-		return m_targetVelocity;
+		const VehicleStore& store = m_trafficState.getVehicleStore();
+		return store.getColumns().targetVelocities[store.getIndex(m_id)];
 	}
 
 
 	double AbstractVehicle::getEffectiveTargetVelocity() const
 	{
-		return std::min(m_multiplierTargetVelocity * m_targetVelocity, m_currentConnection->getTargetVelocity());
+		return std::min(m_multiplierTargetVelocity * getTargetVelocity(), m_currentConnection->getTargetVelocity());
+	}
+
+
+	const TrafficState& AbstractVehicle::getTrafficState() const
+	{
+		return m_trafficState;
+	}
+
+
+	VehicleId AbstractVehicle::getVehicleId() const
+	{
+		return m_id;
+	}
+
+
+	const Routing& AbstractVehicle::getRouting() const
+	{
+		return m_routing;
+	}
+
+
+	double AbstractVehicle::getLookaheadDistance()
+	{
+		return m_lookaheadDistance;
+	}
+
+
+	size_t AbstractVehicle::getNumRegistrationOverflows() const
+	{
+		return m_registeredIntersections.getNumOverflows();
+	}
+
+
+	double AbstractVehicle::getRouteRepairThreshold() const
+	{
+		return m_routeRepairThreshold;
+	}
+
+
+	void AbstractVehicle::setRouteRepairThreshold(double value)
+	{
+		m_routeRepairThreshold = value;
+	}
+
+
+	RoutePlanner* AbstractVehicle::getRoutePlanner() const
+	{
+		return m_routePlanner;
+	}
+
+
+	void AbstractVehicle::setRoutePlanner(RoutePlanner* value)
+	{
+		m_routePlanner = value;
+	}
+
+
+	size_t AbstractVehicle::getNumRouteComputations() const
+	{
+		return m_numRouteComputations;
+	}
+
+
+	size_t AbstractVehicle::getNumRouteRepairs() const
+	{
+		return m_numRouteRepairs;
 	}
 
 
@@ -94,24 +180,38 @@ namespace cts { namespace core
 	void AbstractVehicle::setCurrentConnection(const Connection* value)
 	{
 		if (m_currentConnection != nullptr)
-			const_cast<Connection*>(m_currentConnection)->removeVehicle(this);
+			m_trafficState.removeVehicle(*m_currentConnection, this);
 
 		m_currentConnection = value;
 
+		VehicleStore& store = m_trafficState.getVehicleStore();
+		const size_t index = store.getIndex(m_id);
+		store.getColumns().connectionIndices[index] = (m_currentConnection != nullptr) ? uint32_t(m_currentConnection->getIndex()) : VehicleStore::noConnection;
+		store.getColumns().connectionLengths[index] = (m_currentConnection != nullptr) ? m_currentConnection->getCurve().getArcLength() : 0.0;
+
 		if (m_currentConnection != nullptr)
-			const_cast<Connection*>(m_currentConnection)->addVehicle(this, m_currentArcPosition);
+			m_trafficState.addVehicle(*m_currentConnection, this, getCurrentArcPosition());
 	}
 
 
 	double AbstractVehicle::getCurrentArcPosition() const
 	{
-		return m_currentArcPosition;
+		const VehicleStore& store = m_trafficState.getVehicleStore();
+		return store.getColumns().arcPositions[store.getIndex(m_id)];
 	}
 
 
 	void AbstractVehicle::setCurrentArcPosition(double value)
 	{
-		m_currentArcPosition = value;
+		VehicleStore& store = m_trafficState.getVehicleStore();
+		store.getColumns().arcPositions[store.getIndex(m_id)] = value;
+	}
+
+
+	double AbstractVehicle::getCurrentVelocity() const
+	{
+		const VehicleStore& store = m_trafficState.getVehicleStore();
+		return store.getColumns().velocities[store.getIndex(m_id)];
 	}
 
 
@@ -121,6 +221,38 @@ namespace cts { namespace core
 	}
 
 
+	double AbstractVehicle::getSpawnTime() const
+	{
+		return m_spawnTime;
+	}
+
+
+	void AbstractVehicle::setSpawnTime(double value)
+	{
+		m_spawnTime = value;
+	}
+
+
+	double AbstractVehicle::getTravelledDistance() const
+	{
+		const VehicleStore& store = m_trafficState.getVehicleStore();
+		return store.getColumns().travelledDistances[store.getIndex(m_id)];
+	}
+
+
+	bool AbstractVehicle::hasArrived() const
+	{
+		return m_arrived;
+	}
+
+
+	const AbstractVehicle::State& AbstractVehicle::getFrozenState() const
+	{
+		const VehicleStore& store = m_trafficState.getVehicleStore();
+		return store.getColumns().frozenStates[store.getIndex(m_id)];
+	}
+
+
 	void AbstractVehicle::prepare(double currentTime)
 	{
 		auto tailIt = m_registeredIntersections.begin(); // pointer to the first SpecificIntersection behind the vehicle's tail
@@ -153,7 +285,7 @@ namespace cts { namespace core
 		}
 		
 		// gather next intersections on my route and updated their registration
-		double startPosition = m_currentArcPosition;
+		double startPosition = getCurrentArcPosition();
 		double doneDistance = 0.0;
 		double remainingDistance = m_lookaheadDistance;
 
@@ -189,8 +321,7 @@ namespace cts { namespace core
 			for (/**/; startIt != endIt; ++startIt)
 			{
 				double d = (*startIt)->getMyArcPosition(*segment.connection) - startPosition + doneDistance;
-				m_registeredIntersections.emplace_back(this, *startIt, segment.connection);
-				m_registeredIntersections.back().update(d, vec2(currentTime + computeArrivalTime(d - (*startIt)->getWaitingDistance()), currentTime + computeArrivalTime(d + m_length + (*startIt)->getWaitingDistance())));
+				m_registeredIntersections.emplace_back(m_trafficState, this, *startIt, segment.connection, d, vec2(currentTime + computeArrivalTime(d - (*startIt)->getWaitingDistance()), currentTime + computeArrivalTime(d + m_length + (*startIt)->getWaitingDistance())));
 			}
 
 			remainingDistance -= segment.connection->getCurve().getArcLength() - startPosition;
@@ -202,116 +333,113 @@ namespace cts { namespace core
 	}
 
 
-	void AbstractVehicle::think()
+	void AbstractVehicle::setAcceleration(double value)
 	{
-		m_acceleration = think(m_routing);
+		VehicleStore& store = m_trafficState.getVehicleStore();
+		store.getColumns().accelerations[store.getIndex(m_id)] = value;
 	}
 
 
-	double AbstractVehicle::think(const Routing& routing) const
+	void AbstractVehicle::publishDecisions()
 	{
-		if (routing.getSegments().empty())
-			return 0.0;
-
-		assert(m_currentConnection == m_routing.getSegments()[0].connection);
-
-		// TODO...
-		AccelerationDistance ad = thinkOfVehiclesInFront(m_lookaheadDistance);
-		AccelerationDistance ad2 = thinkOfIntersection(ad.considerable ? ad.distance : 0.0);
-		//minAcceleration = std::min(minAcceleration, getAcceleration(m_velocity, getEffectiveTargetVelocity(), distanceToIntersection, m_velocity));
-		return std::min(ad.acceleration, ad2.acceleration);
+		for (auto& si : m_registeredIntersections)
+		{
+			si.publishWait();
+		}
 	}
 
 
-	void AbstractVehicle::move(double tickLength)
+	void AbstractVehicle::leaveConnection()
 	{
 		if (m_currentConnection == nullptr)
 			return;
 
-		m_velocity = std::max(0.0, m_velocity + m_acceleration);
-		const double arcLengthToMove = m_velocity * tickLength * 10.0;
-
-		m_currentArcPosition += arcLengthToMove;
-		if (m_currentArcPosition > m_currentConnection->getCurve().getArcLength())
+		setCurrentArcPosition(getCurrentArcPosition() - m_currentConnection->getCurve().getArcLength());
+		if (m_routing.getSegments().size() == 1)
 		{
-			m_currentArcPosition -= m_currentConnection->getCurve().getArcLength();
-			if (m_routing.getSegments().size() == 1)
-			{
-				setCurrentConnection(nullptr);
-				return;
-			}
-			else
-			{
-				m_visitedConnections.push_back(m_currentConnection);
+			m_arrived = true;
+			setCurrentConnection(nullptr);
+		}
+		else
+		{
+			m_visitedConnections.push_back(m_currentConnection);
+
+			// only search for a new route if the traffic on the remaining one changed materially
+			m_routing.advance();
+			const bool searchRoute = m_routeRepairThreshold < 0.0 || m_routing.computeCostChange(*this) > m_routeRepairThreshold;
+			const bool planAsynchronously = m_routePlanner != nullptr && !m_trafficState.getRouteTrees().isEnabled();
+			if (!searchRoute)
+				++m_numRouteRepairs;
+			else if (!planAsynchronously)
 				updateRouting(m_currentConnection->getEndNode(), m_destinationNodes);
-				setCurrentConnection(m_routing.getSegments()[0].connection);
-			}
+			setCurrentConnection(m_routing.getSegments()[0].connection);
+
+			// keep following the remaining route while the new one is planned from the end of the next connection
+			if (searchRoute && planAsynchronously && m_routing.getSegments().size() > 1)
+				m_routePlanner->request(*this, m_currentConnection->getEndNode(), m_destinationNodes);
 		}
 	}
 
 
-	double AbstractVehicle::computeArrivalTime(double distance) const
+	void AbstractVehicle::continueRouting(const Routing& continuation)
 	{
-		if (distance < 0.0)
-			return 0.0;
+		++m_numRouteComputations;
 
-		// distance is in dm, velocity in m/s. For easier calculations, we transform the distance unit to meters.
-		distance /= 10;
-
-		const bool keepVelocity = false;
-		if (keepVelocity)
-		{
-			return distance / m_velocity;
-		}
-		else
-		{
-			double alreadyCoveredDistance = 0.0;
-			int alreadySpentTime = 0;
-			double currentVelocity = m_velocity;
-			double effDesVel = getEffectiveTargetVelocity();
+		// keep the remaining route if none of the destination nodes can be reached anymore
+		if (m_currentConnection == nullptr || (continuation.getSegments().empty() && !utils::contains(m_destinationNodes, &m_currentConnection->getEndNode())))
+			return;
+		m_routing.continueWith(continuation);
+		m_routing.intern(m_trafficState.getRouteStore());
+	}
 
-			while (alreadyCoveredDistance <= distance)
-			{
-				currentVelocity += getAcceleration(currentVelocity, effDesVel);
-				alreadyCoveredDistance += currentVelocity;
-				alreadySpentTime++;
-			}
 
-			return alreadySpentTime - ((alreadyCoveredDistance - distance) / currentVelocity);
-		}
+	double AbstractVehicle::computeArrivalTime(double distance) const
+	{
+		// distance is in dm, velocity in m/s. For easier calculations, we transform the distance unit to meters.
+		// prepare() asks for several distances with the same velocities, hence look them up in the
+		// tabulated trajectory instead of integrating the free-road acceleration for each one.
+		return m_arrivalTimeProfile.getArrivalTime(getCurrentVelocity(), getEffectiveTargetVelocity(), distance / 10, [this](double velocity, double desiredVelocity) {
+			return getAcceleration(velocity, desiredVelocity);
+		});
 	}
 
 
-	AbstractVehicle::AccelerationDistance AbstractVehicle::thinkOfVehiclesInFront(double lookaheadDistance) const
+	AbstractVehicle::Obstacle AbstractVehicle::thinkOfVehiclesInFront() const
 	{
-		// Find the next vehicle in front of me
+		assert(m_currentConnection == m_routing.getSegments()[0].connection);
+
+		// The next vehicle in front of me along my route was already determined for all vehicles at once.
 		// TODO: The original code also considers parallel connections if we're currently at the very beginning of our 
 		// current connection. However, I would assume that this should also be covered by the intersection handling code.
-		VehicleDistance vd = m_currentConnection->getVehicleBehind(m_currentArcPosition, lookaheadDistance);
+		const double velocity = getCurrentVelocity();
+		const VehicleStore& store = m_trafficState.getVehicleStore();
+		const size_t index = store.getIndex(m_id);
+		const VehicleDistance vd(store.getColumns().leaders[index], store.getColumns().leaderDistances[index]);
 
 		if (vd.empty())
 		{
-			return{ false, getAcceleration(m_velocity, getEffectiveTargetVelocity(), lookaheadDistance, m_velocity), lookaheadDistance };
+			return{ false, m_lookaheadDistance, velocity };
 		}
 		else
 		{
+			// only consider the frozen state of the other vehicle, since it might be thinking concurrently.
+			const State& other = vd.vehicle->getFrozenState();
 			const double distance = vd.distance - vd.vehicle->getLength();
-			return{ vd.vehicle->m_acceleration < 0.0, getAcceleration(m_velocity, getEffectiveTargetVelocity(), distance, m_velocity - vd.vehicle->m_velocity), distance };
+			return{ other.acceleration < 0.0, distance, velocity - other.velocity };
 		}
 	}
 
 
-	AbstractVehicle::AccelerationDistance AbstractVehicle::thinkOfIntersection(double stopPoint) const
+	AbstractVehicle::Obstacle AbstractVehicle::thinkOfIntersection(double stopPoint, double minimumDistance) const
 	{
-		const double s0 = getDesiredDistance(0, 0);
+		const double s0 = minimumDistance;
 		for (auto it = m_registeredIntersections.begin(); it != m_registeredIntersections.end(); ++it)
 		{
 			auto& si = *it;
 			bool waitInFront = false;
 			bool avoidBlocking = true;
 
-			auto& myCvt = si.intersection->getCrossingVehicleInfo(*this, *si.connection);
-			auto cvtList = si.intersection->computeInterferingVehicles(*this, *si.connection);
+			auto& myCvt = si.getCrossingVehicleInfo();
 			const Connection& otherConnection = si.intersection->getOtherConnection(*si.connection);
 
 			// We do not need to consider already blocked intersections
@@ -324,8 +452,10 @@ namespace cts { namespace core
 			{
 				// If there is any interfering vehicle, I should wait in front of the intersection.
 				// TODO:	Develop s.th. more convenient (e.g. if possible, try to accelerate a little to get through first).
-				if (!cvtList.empty())
+				m_trafficState.forEachInterferingVehicle(*si.intersection, *si.connection, si.handle, [&waitInFront](const Intersection::CrossingVehicleInfo&) {
 					waitInFront = true;
+					return false;
+				});
 
 				// Intersection is close to stop point so that vehicle will block this intersection => wait in front
 				if ((stopPoint > myCvt.remainingDistance) && (stopPoint - m_length - s0 < myCvt.remainingDistance) && (si.intersection->avoidBlocking()))
@@ -339,15 +469,14 @@ namespace cts { namespace core
 					waitInFront = true;
 
 				// check at each intersection, which vehicle was there first
-				for (auto& otherCvt : cvtList)
-				{
+				m_trafficState.forEachInterferingVehicle(*si.intersection, *si.connection, si.handle, [&](const Intersection::CrossingVehicleInfo& otherCvt) {
 					// I should wait if:
 					//  - The other vehicle originally reached the intersection before me
 					//  - TODO: I would block him significantly if I continue.
 					if (myCvt.originalArrivalTime > otherCvt.originalArrivalTime || otherCvt.remainingDistance < 0)
 					{
 						waitInFront = true;
-						break;
+						return false;
 					}
 
 					// I should also wait if the other vehicle is already blocking the intersection
@@ -355,9 +484,10 @@ namespace cts { namespace core
 					{
 						waitInFront = true;
 						avoidBlocking = false;
-						break;
+						return false;
 					}
-				}
+					return true;
+				});
 			}
 			// My connection is more important than the other one
 			else
@@ -366,15 +496,15 @@ namespace cts { namespace core
 				// Above is ensured, that the other vehicle will wait (hopefully, it does... o_O)
 
 				// If otherwise the other vehicle is already blocking the intersection, I'm doing good in waiting in front of it.
-				for (auto& otherCvt : cvtList)
-				{
+				m_trafficState.forEachInterferingVehicle(*si.intersection, *si.connection, si.handle, [&](const Intersection::CrossingVehicleInfo& otherCvt) {
 					if (otherCvt.remainingDistance <= 0)
 					{
 						waitInFront = true;
 						avoidBlocking = false;
-						break;
+						return false;
 					}
-				}
+					return true;
+				});
 			}
 
 			if (waitInFront)
@@ -389,7 +519,7 @@ namespace cts { namespace core
 					for (/**/; rit != m_registeredIntersections.rend(); ++rit)
 					{
 						auto& prevSi = *rit;
-						auto& prevCvt = prevSi.intersection->getCrossingVehicleInfo(*this, *prevSi.connection);
+						auto& prevCvt = prevSi.getCrossingVehicleInfo();
 
 						// do not consider intersections that I am already blocking - I can't help this anymore
 						if (prevCvt.remainingDistance <= 0.0)
@@ -422,7 +552,7 @@ namespace cts { namespace core
 					it = rit.base();
 				}
 
-				const double distance = it->intersection->getCrossingVehicleInfo(*this, *it->connection).remainingDistance - it->intersection->getWaitingDistance();
+				const double distance = it->getCrossingVehicleInfo().remainingDistance - it->intersection->getWaitingDistance();
 
 				// Update this and all following intersections, that I won't cross in the near future.
 				for (/**/; it != m_registeredIntersections.end(); ++it)
@@ -430,7 +560,7 @@ namespace cts { namespace core
 					it->setWait(true);
 				}
 
-				return{ true, getAcceleration(m_velocity, getEffectiveTargetVelocity(), distance, m_velocity), distance };
+				return{ true, distance, getCurrentVelocity() };
 			}
 			else
 			{
@@ -439,24 +569,51 @@ namespace cts { namespace core
 		}
 
 
-		return{ false, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity() };
+		return{ false, std::numeric_limits<double>::infinity(), 0.0 };
 	}
 
 
 	void AbstractVehicle::updateRouting(const Node& startNode, std::vector<Node*> destinationNodes)
 	{
-		m_routing.compute(startNode, destinationNodes, *this);
+		RouteTreeCache& routeTrees = m_trafficState.getRouteTrees();
+		RouteStore& routeStore = m_trafficState.getRouteStore();
+		if (routeTrees.isEnabled())
+		{
+			m_routing.follow(routeTrees.getTree(destinationNodes, getTargetVelocity()), startNode, *this);
+		}
+		else if (!routeStore.isQueryCacheEnabled())
+		{
+			m_routing.compute(startNode, destinationNodes, *this);
+		}
+		else
+		{
+			// identical queries during the same congestion revision yield identical routes
+			const RouteStore::Query query = RouteStore::makeQuery(startNode, destinationNodes, getTargetVelocity());
+			std::shared_ptr<const Route> route = routeStore.find(query);
+			if (route != nullptr)
+			{
+				m_routing.setRoute(std::move(route));
+			}
+			else
+			{
+				m_routing.compute(startNode, destinationNodes, *this);
+				routeStore.insert(query, m_routing.getRoute());
+			}
+		}
+		m_routing.intern(routeStore);
+		++m_numRouteComputations;
 	}
 
 
 	double AbstractVehicle::computeDistance(const Connection& connection, double arcPos) const
 	{
+		const double currentArcPosition = getCurrentArcPosition();
 		if (&connection == m_currentConnection)
-			return arcPos - m_currentArcPosition;
+			return arcPos - currentArcPosition;
 
 		// check visited nodes
 		{
-			double acc = -m_currentArcPosition;
+			double acc = -currentArcPosition;
 			for (auto it = m_visitedConnections.rbegin(); it != m_visitedConnections.rend(); ++it)
 			{
 				if (&connection == *it)
@@ -467,7 +624,7 @@ namespace cts { namespace core
 
 		// check upcoming nodes
 		{
-			double acc = m_currentConnection->getCurve().getArcLength() - m_currentArcPosition;
+			double acc = m_currentConnection->getCurve().getArcLength() - currentArcPosition;
 			for (auto& c : m_routing.getSegments())
 			{
 				if (&connection == c.connection)
@@ -480,28 +637,54 @@ namespace cts { namespace core
 	}
 
 
-	AbstractVehicle::SpecificIntersection::SpecificIntersection(const AbstractVehicle* vehicle, Intersection* intersection, const Connection* connection)
-		: vehicle(vehicle)
+	AbstractVehicle::SpecificIntersection::SpecificIntersection(TrafficState& trafficState, const AbstractVehicle* vehicle, const Intersection* intersection, const Connection* connection, double remainingDistance, vec2 blockingTime)
+		: trafficState(&trafficState)
+		, vehicle(vehicle)
 		, intersection(intersection)
 		, connection(connection)
+		, handle(trafficState.registerVehicle(*intersection, *vehicle, *connection, remainingDistance, blockingTime))
 	{}
 
 
+	AbstractVehicle::SpecificIntersection::SpecificIntersection(SpecificIntersection&& other)
+		: trafficState(other.trafficState)
+		, vehicle(other.vehicle)
+		, intersection(other.intersection)
+		, connection(other.connection)
+		, handle(other.handle)
+	{
+		other.trafficState = nullptr;
+	}
+
+
 	AbstractVehicle::SpecificIntersection::~SpecificIntersection()
 	{
-		intersection->unregisterVehicle(*vehicle, *connection);
+		if (trafficState != nullptr)
+			trafficState->unregisterVehicle(*intersection, *connection, handle);
 	}
 
 
 	void AbstractVehicle::SpecificIntersection::update(double remainingDistance, vec2 blockingTime) const
 	{
-		intersection->registerVehicle(*vehicle, *connection, remainingDistance, blockingTime);
+		trafficState->updateVehicle(*intersection, *connection, handle, remainingDistance, blockingTime);
 	}
 
 
 	void AbstractVehicle::SpecificIntersection::setWait(bool willWaitInFront) const
 	{
-		intersection->updateVehicleWait(*vehicle, *connection, willWaitInFront);
+		trafficState->updateVehicleWait(*intersection, *connection, handle, willWaitInFront);
+	}
+
+
+	void AbstractVehicle::SpecificIntersection::publishWait() const
+	{
+		trafficState->publishVehicleWait(*intersection, *connection, handle);
+	}
+
+
+	const Intersection::CrossingVehicleInfo& AbstractVehicle::SpecificIntersection::getCrossingVehicleInfo() const
+	{
+		return trafficState->getCrossingVehicleInfo(*intersection, *connection, handle);
 	}
 
 
@@ -0,0 +1,171 @@
+#include <cts-core/traffic/vehiclestore.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace cts { namespace core
+{
+
+	const uint32_t VehicleStore::noConnection;
+
+
+	namespace
+	{
+		/// Id of rows that were removed but not yet erased.
+		const VehicleId removedId = std::numeric_limits<VehicleId>::max();
+
+		/// Erases the entries of all removed rows from \e column while keeping the order of all other entries.
+		template<typename T>
+		void eraseRemovedRows(std::vector<T>& column, const std::vector<VehicleId>& ids)
+		{
+			size_t j = 0;
+			for (size_t i = 0; i < column.size(); ++i)
+			{
+				if (ids[i] != removedId)
+					column[j++] = column[i];
+			}
+			column.resize(j);
+		}
+	}
+
+
+	VehicleId VehicleStore::add(AbstractVehicle* vehicle, double velocity, double targetVelocity)
+	{
+		VehicleId id;
+		if (m_freeIds.empty())
+		{
+			id = VehicleId(m_indices.size());
+			m_indices.push_back(0);
+		}
+		else
+		{
+			id = m_freeIds.back();
+			m_freeIds.pop_back();
+		}
+
+		m_indices[id] = uint32_t(m_vehicles.size());
+		m_vehicles.push_back(vehicle);
+		m_ids.push_back(id);
+
+		m_columns.arcPositions.push_back(0.0);
+		m_columns.velocities.push_back(velocity);
+		m_columns.accelerations.push_back(0.0);
+		m_columns.targetVelocities.push_back(targetVelocity);
+		m_columns.travelledDistances.push_back(0.0);
+		m_columns.connectionIndices.push_back(noConnection);
+		m_columns.connectionLengths.push_back(0.0);
+		m_columns.frozenStates.push_back(VehicleState{ 0.0, velocity, 0.0 });
+		m_columns.leaders.push_back(nullptr);
+		m_columns.leaderDistances.push_back(0.0);
+
+		return id;
+	}
+
+
+	void VehicleStore::remove(VehicleId id)
+	{
+		assert(id < m_indices.size());
+		const size_t index = m_indices[id];
+		assert(index < m_ids.size() && m_ids[index] == id);
+
+		// erasing rows moves all following rows, hence this is done for all removed rows at once by compact()
+		m_vehicles[index] = nullptr;
+		m_ids[index] = removedId;
+		m_columns.connectionIndices[index] = noConnection;
+		m_columns.leaders[index] = nullptr;
+		m_removedIds.push_back(id);
+	}
+
+
+	void VehicleStore::compact()
+	{
+		if (m_removedIds.empty())
+			return;
+
+		eraseRemovedRows(m_columns.arcPositions, m_ids);
+		eraseRemovedRows(m_columns.velocities, m_ids);
+		eraseRemovedRows(m_columns.accelerations, m_ids);
+		eraseRemovedRows(m_columns.targetVelocities, m_ids);
+		eraseRemovedRows(m_columns.travelledDistances, m_ids);
+		eraseRemovedRows(m_columns.connectionIndices, m_ids);
+		eraseRemovedRows(m_columns.connectionLengths, m_ids);
+		eraseRemovedRows(m_columns.frozenStates, m_ids);
+		eraseRemovedRows(m_columns.leaders, m_ids);
+		eraseRemovedRows(m_columns.leaderDistances, m_ids);
+		eraseRemovedRows(m_vehicles, m_ids);
+		m_ids.erase(std::remove(m_ids.begin(), m_ids.end(), removedId), m_ids.end());
+
+		for (size_t i = 0; i < m_ids.size(); ++i)
+			m_indices[m_ids[i]] = uint32_t(i);
+
+		// ids only become free once their rows are gone
+		m_freeIds.insert(m_freeIds.end(), m_removedIds.begin(), m_removedIds.end());
+		m_removedIds.clear();
+	}
+
+
+	size_t VehicleStore::size() const
+	{
+		return m_vehicles.size();
+	}
+
+
+	AbstractVehicle* VehicleStore::getVehicle(size_t index) const
+	{
+		return m_vehicles[index];
+	}
+
+
+	VehicleStore::Columns& VehicleStore::getColumns()
+	{
+		return m_columns;
+	}
+
+
+	const VehicleStore::Columns& VehicleStore::getColumns() const
+	{
+		return m_columns;
+	}
+
+
+	void VehicleStore::freeze()
+	{
+		const size_t n = size();
+		const double* arcPositions = m_columns.arcPositions.data();
+		const double* velocities = m_columns.velocities.data();
+		const double* accelerations = m_columns.accelerations.data();
+		VehicleState* frozenStates = m_columns.frozenStates.data();
+
+		for (size_t i = 0; i < n; ++i)
+			frozenStates[i] = VehicleState{ arcPositions[i], velocities[i], accelerations[i] };
+	}
+
+
+	void VehicleStore::move(double tickLength, std::vector<size_t>& leavingVehicles)
+	{
+		const size_t n = size();
+		double* arcPositions = m_columns.arcPositions.data();
+		double* velocities = m_columns.velocities.data();
+		const double* accelerations = m_columns.accelerations.data();
+		double* travelledDistances = m_columns.travelledDistances.data();
+		const uint32_t* connectionIndices = m_columns.connectionIndices.data();
+		const double* connectionLengths = m_columns.connectionLengths.data();
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			if (connectionIndices[i] == noConnection)
+				continue;
+
+			velocities[i] = std::max(0.0, velocities[i] + accelerations[i]);
+			const double arcLengthToMove = velocities[i] * tickLength * 10.0;
+
+			arcPositions[i] += arcLengthToMove;
+			travelledDistances[i] += arcLengthToMove;
+			if (arcPositions[i] > connectionLengths[i])
+				leavingVehicles.push_back(i);
+		}
+	}
+
+
+}
+}
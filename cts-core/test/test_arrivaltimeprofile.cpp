@@ -0,0 +1,79 @@
+#include <catch.hpp>
+
+#include <cts-core/traffic/arrivaltimeprofile.h>
+#include <cts-core/traffic/vehicle.h>
+
+using namespace cts;
+using namespace cts::core;
+
+
+namespace
+{
+	// Integrates the free-road trajectory for each query, as AbstractVehicle::computeArrivalTime() used to.
+	double integrateArrivalTime(const IdmMobil& idm, double velocity, double desiredVelocity, double distance)
+	{
+		if (distance < 0.0)
+			return 0.0;
+
+		double alreadyCoveredDistance = 0.0;
+		int alreadySpentTime = 0;
+		while (alreadyCoveredDistance <= distance)
+		{
+			velocity += idm.getAcceleration(velocity, desiredVelocity);
+			alreadyCoveredDistance += velocity;
+			alreadySpentTime++;
+		}
+
+		return alreadySpentTime - ((alreadyCoveredDistance - distance) / velocity);
+	}
+}
+
+
+TEST_CASE("ArrivalTimeProfile/exact", "Check the tabulated arrival times against integrating the trajectory for each query")
+{
+	IdmMobil idm;
+	auto freeRoadAcceleration = [&idm](double velocity, double desiredVelocity) { return idm.getAcceleration(velocity, desiredVelocity); };
+
+	ArrivalTimeProfile profile;
+	bool allEqual = true;
+	for (double desiredVelocity = 5.0; desiredVelocity <= 42.0; desiredVelocity += 1.5)
+	{
+		for (double velocity = 0.0; velocity <= 1.5 * desiredVelocity; velocity += 0.75)
+		{
+			for (double distance = -1.0; distance <= 100.0; distance += 0.7)
+			{
+				// we explicitly want bit-identical results here
+				allEqual &= (profile.getArrivalTime(velocity, desiredVelocity, distance, freeRoadAcceleration) == integrateArrivalTime(idm, velocity, desiredVelocity, distance));
+			}
+		}
+	}
+	REQUIRE(allEqual);
+}
+
+
+TEST_CASE("ArrivalTimeProfile/order", "Check that the table does not depend on the order of the queries")
+{
+	IdmMobil idm;
+	auto freeRoadAcceleration = [&idm](double velocity, double desiredVelocity) { return idm.getAcceleration(velocity, desiredVelocity); };
+
+	ArrivalTimeProfile profile;
+	REQUIRE(profile.getArrivalTime(3.0, 14.0, -5.0, freeRoadAcceleration) == 0.0);
+
+	const double far = profile.getArrivalTime(3.0, 14.0, 250.0, freeRoadAcceleration);
+	const size_t numSteps = profile.getNumSteps();
+	REQUIRE(numSteps > 0);
+
+	// nearer distances are looked up without extending the table
+	const double near = profile.getArrivalTime(3.0, 14.0, 20.0, freeRoadAcceleration);
+	REQUIRE(profile.getNumSteps() == numSteps);
+	REQUIRE(near < far);
+
+	ArrivalTimeProfile freshProfile;
+	REQUIRE(freshProfile.getArrivalTime(3.0, 14.0, 20.0, freeRoadAcceleration) == near);
+	REQUIRE(freshProfile.getNumSteps() < numSteps);
+	REQUIRE(freshProfile.getArrivalTime(3.0, 14.0, 250.0, freeRoadAcceleration) == far);
+
+	// other velocities restart the table
+	REQUIRE(profile.getArrivalTime(8.0, 14.0, 20.0, freeRoadAcceleration) == integrateArrivalTime(idm, 8.0, 14.0, 20.0));
+	REQUIRE(profile.getNumSteps() < numSteps);
+}
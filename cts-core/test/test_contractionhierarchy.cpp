@@ -0,0 +1,192 @@
+#include <catch.hpp>
+
+#include <cts-core/network/connection.h>
+#include <cts-core/network/contractionhierarchy.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+#include <cts-core/network/routing.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehicle.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace cts;
+using namespace cts::core;
+
+
+namespace
+{
+	// Grid of size x size nodes, neighbors are connected in both directions except for a few one-way streets.
+	void setupGridNetwork(Network& n, int size)
+	{
+		std::vector<Node*> nodes;
+		for (int y = 0; y < size; ++y)
+			for (int x = 0; x < size; ++x)
+				nodes.push_back(n.addNode({ x * 400.0, y * 400.0 }));
+
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				Node* node = nodes[y * size + x];
+				if (x + 1 < size)
+				{
+					n.addConnection(*node, *nodes[y * size + x + 1]);
+					if ((x + y) % 5 != 0)
+						n.addConnection(*nodes[y * size + x + 1], *node);
+				}
+				if (y + 1 < size)
+				{
+					n.addConnection(*nodes[(y + 1) * size + x], *node);
+					if ((x * y) % 7 != 3)
+						n.addConnection(*node, *nodes[(y + 1) * size + x]);
+				}
+			}
+		}
+	}
+
+	// Plain Dijkstra search as reference.
+	double computeReferenceCosts(const Network& n, const std::vector<double>& connectionCosts, const Node& start, const std::vector<Node*>& destinations)
+	{
+		std::vector<double> costs(n.getNumNodes(), std::numeric_limits<double>::infinity());
+		std::vector< std::pair<double, size_t> > openList{ { 0.0, start.getIndex() } };
+		costs[start.getIndex()] = 0.0;
+		while (!openList.empty())
+		{
+			std::pop_heap(openList.begin(), openList.end(), std::greater< std::pair<double, size_t> >());
+			const auto ole = openList.back();
+			openList.pop_back();
+			if (ole.first > costs[ole.second])
+				continue;
+
+			const Node& node = *n.getNodes()[ole.second];
+			if (std::find(destinations.begin(), destinations.end(), &node) != destinations.end())
+				return ole.first;
+
+			for (const Connection* c : node.getOutgoingConnections())
+			{
+				const double newCosts = ole.first + connectionCosts[c->getIndex()];
+				if (newCosts < costs[c->getEndNode().getIndex()])
+				{
+					costs[c->getEndNode().getIndex()] = newCosts;
+					openList.push_back({ newCosts, c->getEndNode().getIndex() });
+					std::push_heap(openList.begin(), openList.end(), std::greater< std::pair<double, size_t> >());
+				}
+			}
+		}
+		return std::numeric_limits<double>::infinity();
+	}
+
+	// Checks that \e path is a connected path from \e start to one of \e destinations with the given costs.
+	bool isValidPath(const std::vector<const Connection*>& path, const std::vector<double>& connectionCosts, const Node& start, const std::vector<Node*>& destinations, double costs)
+	{
+		const Node* node = &start;
+		double pathCosts = 0.0;
+		for (const Connection* c : path)
+		{
+			if (&c->getStartNode() != node)
+				return false;
+			pathCosts += connectionCosts[c->getIndex()];
+			node = &c->getEndNode();
+		}
+		return std::find(destinations.begin(), destinations.end(), node) != destinations.end()
+			&& std::abs(pathCosts - costs) <= 1e-9 * costs;
+	}
+}
+
+
+TEST_CASE("ContractionHierarchy/query", "Check that the hierarchy finds the cheapest paths for changing connection costs")
+{
+	Network n;
+	setupGridNetwork(n, 12);
+	ContractionHierarchy ch(n);
+	REQUIRE(ch.getNumArcs() >= n.getNumConnections() / 2);
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> costDistribution(1.0, 10.0);
+	std::uniform_int_distribution<size_t> nodeDistribution(0, n.getNumNodes() - 1);
+	std::vector<double> connectionCosts(n.getNumConnections());
+
+	// customizing the same hierarchy again must not require rebuilding it
+	for (int customization = 0; customization < 3; ++customization)
+	{
+		for (auto& costs : connectionCosts)
+			costs = costDistribution(rng);
+		if (customization == 2)
+		{
+			// block some connections
+			for (size_t i = 0; i < connectionCosts.size(); i += 9)
+				connectionCosts[i] = std::numeric_limits<double>::infinity();
+		}
+		ch.customize(connectionCosts);
+
+		bool valid = true;
+		bool optimal = true;
+		std::vector<const Connection*> path;
+		for (int i = 0; i < 200; ++i)
+		{
+			const Node& start = *n.getNodes()[nodeDistribution(rng)];
+			std::vector<Node*> destinations{ n.getNodes()[nodeDistribution(rng)].get() };
+			if (i % 3 == 0)
+				destinations.push_back(n.getNodes()[nodeDistribution(rng)].get());
+
+			const double expected = computeReferenceCosts(n, connectionCosts, start, destinations);
+			const double costs = ch.query(start, destinations, path);
+			if (std::isinf(expected))
+			{
+				valid &= path.empty();
+				optimal &= std::isinf(costs);
+			}
+			else
+			{
+				valid &= isValidPath(path, connectionCosts, start, destinations, costs);
+				optimal &= (std::abs(costs - expected) <= 1e-9 * expected);
+			}
+		}
+		REQUIRE(valid);
+		REQUIRE(optimal);
+	}
+}
+
+
+TEST_CASE("ContractionHierarchy/routing", "Check Routing using a hierarchy customized with the costs of a vehicle")
+{
+	Network n;
+	setupGridNetwork(n, 8);
+	for (Connection& c : n.getConnections())
+		c.setTargetVelocity(c.getIndex() % 3 == 0 ? 20 : 8);
+
+	TrafficState state(n);
+	const std::vector<Node*> destinations{ n.getNodes().back().get() };
+	TypedVehicle<IdmMobil> v1(state, *n.getNodes().front(), destinations, 10);
+
+	ContractionHierarchy ch(n);
+	ch.customize(state, v1.getTargetVelocity());
+
+	// the reverse shortest-path tree yields the exact costs toward the destination
+	RouteTreeCache& cache = state.getRouteTrees();
+	cache.setRefreshInterval(1.0);
+	const auto& tree = cache.getTree(destinations, v1.getTargetVelocity());
+
+	Routing r;
+	for (auto& start : n.getNodes())
+	{
+		r.compute(ch, *start, destinations, v1);
+		double costs = 0.0;
+		for (auto& segment : r.getSegments())
+			costs += segment.costs;
+		REQUIRE(costs == Approx(tree.costsToGo[start->getIndex()]));
+		if (start.get() != destinations.front())
+		{
+			REQUIRE(!r.getSegments().empty());
+			REQUIRE(r.getSegments().front().start == start.get());
+			REQUIRE(r.getSegments().back().destination == destinations.front());
+		}
+	}
+}
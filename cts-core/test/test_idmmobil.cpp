@@ -0,0 +1,42 @@
+#include <catch.hpp>
+
+#include <cts-core/traffic/vehicle.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace cts;
+using namespace cts::core;
+
+
+TEST_CASE("IdmMobil/batch", "Check the batch acceleration kernel against the scalar IDM")
+{
+	// use an odd number of vehicles to also cover the scalar remainder of the vectorized kernel
+	const size_t count = 1027;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> velocity(0.0, 20.0);
+	std::uniform_real_distribution<double> desiredVelocity(5.0, 20.0);
+	std::uniform_real_distribution<double> distance(1.0, 800.0);
+
+	std::vector<double> velocities(count), desiredVelocities(count), distances(count), vDiffs(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		velocities[i] = velocity(rng);
+		desiredVelocities[i] = desiredVelocity(rng);
+		distances[i] = (i % 5 == 0) ? std::numeric_limits<double>::infinity() : distance(rng);
+		vDiffs[i] = velocities[i] - velocity(rng);
+	}
+
+	IdmMobil idm;
+	std::vector<double> accelerations(count);
+	idm.getAccelerations(count, velocities.data(), desiredVelocities.data(), distances.data(), vDiffs.data(), accelerations.data());
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const double expected = (i % 5 == 0)
+			? idm.getAcceleration(velocities[i], desiredVelocities[i])
+			: idm.getAcceleration(velocities[i], desiredVelocities[i], distances[i], vDiffs[i]);
+		REQUIRE(std::abs(accelerations[i] - expected) <= IdmMobil::batchTolerance * std::max(1.0, std::abs(expected)));
+	}
+}
@@ -94,12 +94,57 @@ TEST_CASE("Network/connections", "Check adding/removing Connections to a Network
 	REQUIRE(n3->getIncomingConnections()[0] == c2);
 	REQUIRE(n3->getIncomingConnections()[1] == c3);
 
+	REQUIRE(c1->getIndex() == 0);
+	REQUIRE(c2->getIndex() == 1);
+	REQUIRE(c3->getIndex() == 2);
+
 	n.removeConnection(*c2);
 	REQUIRE(n.getConnections().size() == 2);
 	REQUIRE(&n.getConnections()[0].get() == c1);
 	REQUIRE(&n.getConnections()[1].get() == c3);
+	REQUIRE(c1->getIndex() == 0);
+	REQUIRE(c3->getIndex() == 1);
 	REQUIRE(n1->getOutgoingConnections().size() == 2);
 	REQUIRE(n2->getOutgoingConnections().size() == 0);
 	REQUIRE(n3->getIncomingConnections().size() == 1);
 	REQUIRE(n3->getIncomingConnections()[0] == c3);
 }
+
+
+TEST_CASE("Network/intersections", "Check that the detected intersections do not depend on the number of threads")
+{
+	Network sequential;
+	sequential.importLegacyXml(CTS_TEST_DATA_DIR "/intersection.xml", 1);
+	REQUIRE(!sequential.getIntersections().empty());
+
+	for (size_t numThreads : { 2, 4, 8 })
+	{
+		Network n;
+		n.importLegacyXml(CTS_TEST_DATA_DIR "/intersection.xml", numThreads);
+
+		REQUIRE(n.getIntersections().size() == sequential.getIntersections().size());
+		for (size_t i = 0; i < n.getIntersections().size(); ++i)
+		{
+			const Intersection& expected = *sequential.getIntersections()[i];
+			const Intersection& actual = *n.getIntersections()[i];
+			REQUIRE(actual.getIndex() == i);
+			REQUIRE(actual.getFirstConnection().getIndex() == expected.getFirstConnection().getIndex());
+			REQUIRE(actual.getSecondConnection().getIndex() == expected.getSecondConnection().getIndex());
+			REQUIRE(actual.getFirstTime() == expected.getFirstTime());
+			REQUIRE(actual.getSecondTime() == expected.getSecondTime());
+		}
+
+		// each connection keeps its intersections in the same order
+		const auto connections = n.getConnections();
+		const auto sequentialConnections = sequential.getConnections();
+		REQUIRE(connections.size() == sequentialConnections.size());
+		for (size_t i = 0; i < connections.size(); ++i)
+		{
+			const auto& intersections = connections[i].get().getIntersections();
+			const auto& expected = sequentialConnections[i].get().getIntersections();
+			REQUIRE(intersections.size() == expected.size());
+			for (size_t j = 0; j < intersections.size(); ++j)
+				REQUIRE(intersections[j]->getIndex() == expected[j]->getIndex());
+		}
+	}
+}
@@ -0,0 +1,117 @@
+#include <catch.hpp>
+
+#include <cts-core/base/ringbuffer.h>
+
+#include <deque>
+#include <random>
+
+using namespace cts;
+using namespace cts::core;
+
+
+namespace
+{
+	/// Counts the number of living instances to check that the buffer destroys all elements.
+	struct Counted
+	{
+		explicit Counted(int value) : value(value) { ++numInstances; }
+		Counted(Counted&& other) : value(other.value) { ++numInstances; }
+		~Counted() { --numInstances; }
+
+		int value;
+		static int numInstances;
+	};
+
+	int Counted::numInstances = 0;
+}
+
+
+TEST_CASE("RingBuffer/basic", "Check adding and removing elements at both ends")
+{
+	{
+		RingBuffer<Counted> rb(3);
+		REQUIRE(rb.capacity() == 4);
+		REQUIRE(rb.empty());
+
+		for (int i = 0; i < 4; ++i)
+			rb.emplace_back(i);
+		REQUIRE(rb.size() == 4);
+		REQUIRE(rb.front().value == 0);
+		REQUIRE(rb.back().value == 3);
+		REQUIRE(Counted::numInstances == 4);
+
+		// iterators to the remaining elements stay valid when removing elements from the front
+		auto it = std::next(rb.begin(), 2);
+		auto next = rb.erase(rb.begin(), it);
+		REQUIRE(next == rb.begin());
+		REQUIRE(it == rb.begin());
+		REQUIRE(it->value == 2);
+		REQUIRE(Counted::numInstances == 2);
+
+		// wrap around without growing
+		rb.emplace_back(4);
+		rb.emplace_back(5);
+		REQUIRE(rb.size() == 4);
+		REQUIRE(rb.capacity() == 4);
+		REQUIRE(rb.getNumOverflows() == 0);
+		REQUIRE(it->value == 2);
+
+		int expected = 5;
+		for (auto rit = rb.rbegin(); rit != rb.rend(); ++rit)
+			REQUIRE(rit->value == expected--);
+
+		// growing keeps the order and all iterators
+		rb.emplace_back(6);
+		REQUIRE(rb.capacity() == 8);
+		REQUIRE(rb.getNumOverflows() == 1);
+		REQUIRE(it->value == 2);
+		expected = 2;
+		for (auto& c : rb)
+			REQUIRE(c.value == expected++);
+		REQUIRE(Counted::numInstances == 5);
+
+		// remove from the back
+		next = rb.erase(std::next(it, 3), rb.end());
+		REQUIRE(next == rb.end());
+		REQUIRE(rb.size() == 3);
+		REQUIRE(rb.back().value == 4);
+		REQUIRE(Counted::numInstances == 3);
+	}
+	REQUIRE(Counted::numInstances == 0);
+}
+
+
+TEST_CASE("RingBuffer/random", "Check the ring buffer against std::deque")
+{
+	std::mt19937 rng(42);
+	RingBuffer<int> rb(8);
+	std::deque<int> reference;
+
+	bool allEqual = true;
+	for (int i = 0; i < 10000; ++i)
+	{
+		const unsigned int op = rng() % 4;
+		if (op < 2)
+		{
+			rb.emplace_back(i);
+			reference.push_back(i);
+		}
+		else if (!reference.empty())
+		{
+			const size_t n = rng() % (reference.size() + 1);
+			if (op == 2)
+			{
+				rb.erase(rb.begin(), std::next(rb.begin(), n));
+				reference.erase(reference.begin(), reference.begin() + n);
+			}
+			else
+			{
+				rb.erase(std::prev(rb.end(), n), rb.end());
+				reference.erase(reference.end() - n, reference.end());
+			}
+		}
+
+		allEqual &= (rb.size() == reference.size()) && std::equal(reference.begin(), reference.end(), rb.begin());
+	}
+	REQUIRE(allEqual);
+}
@@ -1,9 +1,11 @@
 #include <catch.hpp>
 
 #include <cts-core/network/connection.h>
+#include <cts-core/network/landmarks.h>
 #include <cts-core/network/network.h>
 #include <cts-core/network/node.h>
 #include <cts-core/network/routing.h>
+#include <cts-core/traffic/trafficstate.h>
 #include <cts-core/traffic/vehicle.h>
 
 using namespace cts;
@@ -19,8 +21,14 @@ TEST_CASE("routing/basic", "Test basic pathfinding in Routing")
 	// 
 	// Thus, the valid routes are: S1 -> E1, S1 -> E2, S2 -> E2
 	Network n;
-	Node s1({ 0, 0 }), m1({ 1, 0 }), m2({ 2, 0 }), e1({ 3, 0 });
-	Node s2({ 0, 1 }), m3({ 1, 1 }), m4({ 2, 1 }), e2({ 3, 1 });
+	Node& s1 = *n.addNode({ 0, 0 });
+	Node& m1 = *n.addNode({ 1, 0 });
+	Node& m2 = *n.addNode({ 2, 0 });
+	Node& e1 = *n.addNode({ 3, 0 });
+	Node& s2 = *n.addNode({ 0, 1 });
+	Node& m3 = *n.addNode({ 1, 1 });
+	Node& m4 = *n.addNode({ 2, 1 });
+	Node& e2 = *n.addNode({ 3, 1 });
 
 	Connection* c1 = n.addConnection(s1, m1);
 	Connection* c2 = n.addConnection(m1, m2);
@@ -30,10 +38,11 @@ TEST_CASE("routing/basic", "Test basic pathfinding in Routing")
 	Connection* c6 = n.addConnection(m3, m4);
 	Connection* c7 = n.addConnection(m4, e2);
 
-	TypedVehicle<IdmMobil> v1(s1, { &e1 }, 10);
-	TypedVehicle<IdmMobil> v2(s1, { &e2 }, 10);
-	TypedVehicle<IdmMobil> v3(s2, { &e1 }, 10);
-	TypedVehicle<IdmMobil> v4(s2, { &e2 }, 10);
+	TrafficState state(n);
+	TypedVehicle<IdmMobil> v1(state, s1, { &e1 }, 10);
+	TypedVehicle<IdmMobil> v2(state, s1, { &e2 }, 10);
+	TypedVehicle<IdmMobil> v3(state, s2, { &e1 }, 10);
+	TypedVehicle<IdmMobil> v4(state, s2, { &e2 }, 10);
 
 	Routing r;
 	{
@@ -95,8 +104,13 @@ TEST_CASE("routing/shortest", "Test Routing finding the path with the shortest d
 	// 
 	// where the path through M5 is longer
 	Network n;
-	Node s1({ 0, 0 }), m1({ 1, 0 }), m2({ 2, 0 }), m3({ 3, 0 }), m4({ 4, 0 }), e1({ 5, 0 });
-	Node m5({ 2.5, 1 });
+	Node& s1 = *n.addNode({ 0, 0 });
+	Node& m1 = *n.addNode({ 1, 0 });
+	Node& m2 = *n.addNode({ 2, 0 });
+	Node& m3 = *n.addNode({ 3, 0 });
+	Node& m4 = *n.addNode({ 4, 0 });
+	Node& e1 = *n.addNode({ 5, 0 });
+	Node& m5 = *n.addNode({ 2.5, 1 });
 
 	Connection* c1 = n.addConnection(s1, m1);
 	Connection* c2 = n.addConnection(m1, m2);
@@ -106,7 +120,8 @@ TEST_CASE("routing/shortest", "Test Routing finding the path with the shortest d
 	Connection* c6 = n.addConnection(m1, m5);
 	Connection* c7 = n.addConnection(m5, e1);
 
-	TypedVehicle<IdmMobil> v1(s1, { &e1 }, 10);
+	TrafficState state(n);
+	TypedVehicle<IdmMobil> v1(state, s1, { &e1 }, 10);
 
 	Routing r;
 	{
@@ -158,8 +173,11 @@ TEST_CASE("routing/fastest", "Test Routing finding the path with the fastest tar
 	// 
 	// where the path through M3 is longer but faster
 	Network n;
-	Node s1({ 0, 0 }), m1({ 1, 0 }), m2({ 2, 0 }), e1({ 3, 0 });
-	Node m3({ 2, 1 });
+	Node& s1 = *n.addNode({ 0, 0 });
+	Node& m1 = *n.addNode({ 1, 0 });
+	Node& m2 = *n.addNode({ 2, 0 });
+	Node& e1 = *n.addNode({ 3, 0 });
+	Node& m3 = *n.addNode({ 2, 1 });
 
 	Connection* c1 = n.addConnection(s1, m1);
 	Connection* c2 = n.addConnection(m1, m2);
@@ -172,7 +190,8 @@ TEST_CASE("routing/fastest", "Test Routing finding the path with the fastest tar
 	c4->setTargetVelocity(20);
 	c5->setTargetVelocity(20);
 
-	TypedVehicle<IdmMobil> v1(s1, { &e1 }, 20);
+	TrafficState state(n);
+	TypedVehicle<IdmMobil> v1(state, s1, { &e1 }, 20);
 
 	Routing r;
 	{
@@ -220,8 +239,11 @@ TEST_CASE("routing/crowded", "Test Routing finding the path with the least crowd
 	// 
 	// where the path through M3 is longer but less crowded
 	Network n;
-	Node s1({ 0, 0 }), m1({ 1, 0 }), m2({ 2, 0 }), e1({ 3, 0 });
-	Node m3({ 2, 1 });
+	Node& s1 = *n.addNode({ 0, 0 });
+	Node& m1 = *n.addNode({ 1, 0 });
+	Node& m2 = *n.addNode({ 2, 0 });
+	Node& e1 = *n.addNode({ 3, 0 });
+	Node& m3 = *n.addNode({ 2, 1 });
 
 	Connection* c1 = n.addConnection(s1, m1);
 	Connection* c2 = n.addConnection(m1, m2);
@@ -229,8 +251,9 @@ TEST_CASE("routing/crowded", "Test Routing finding the path with the least crowd
 	Connection* c4 = n.addConnection(m1, m3);
 	Connection* c5 = n.addConnection(m3, e1);
 
-	TypedVehicle<IdmMobil> v1(s1, { &e1 }, 20);
-	TypedVehicle<IdmMobil> v2(m2, { &e1 }, 20);
+	TrafficState state(n);
+	TypedVehicle<IdmMobil> v1(state, s1, { &e1 }, 20);
+	TypedVehicle<IdmMobil> v2(state, m2, { &e1 }, 20);
 
 	Routing r;
 	{
@@ -243,7 +266,7 @@ TEST_CASE("routing/crowded", "Test Routing finding the path with the least crowd
 	}
 
 	// add a vehicoe to c5, so that the top path is less crowded/faster
-	TypedVehicle<IdmMobil> v3(m3, { &e1 }, 20);
+	TypedVehicle<IdmMobil> v3(state, m3, { &e1 }, 20);
 	{
 		r.compute(s1, { &e1 }, v1);
 		auto& segments = r.getSegments();
@@ -254,3 +277,279 @@ TEST_CASE("routing/crowded", "Test Routing finding the path with the least crowd
 	}
 
 }
+
+
+TEST_CASE("routing/removedNode", "Test Routing after removing nodes from the network")
+{
+	// Setup is as follows:
+	// S1 --- M1 --- M2 --- E1
+	//            \      /
+	//             - M3 -
+	// 
+	// where M2 is removed, so that the only remaining path is the one through M3
+	Network n;
+	Node& s1 = *n.addNode({ 0, 0 });
+	Node& m1 = *n.addNode({ 1, 0 });
+	Node& m2 = *n.addNode({ 2, 0 });
+	Node& e1 = *n.addNode({ 3, 0 });
+	Node& m3 = *n.addNode({ 2, 1 });
+
+	Connection* c1 = n.addConnection(s1, m1);
+	n.addConnection(m1, m2);
+	n.addConnection(m2, e1);
+	Connection* c4 = n.addConnection(m1, m3);
+	Connection* c5 = n.addConnection(m3, e1);
+
+	n.removeNode(m2);
+	REQUIRE(n.getNumNodes() == 4);
+	for (size_t i = 0; i < n.getNumNodes(); ++i)
+		REQUIRE(n.getNodes()[i]->getIndex() == i);
+
+	TrafficState state(n);
+	TypedVehicle<IdmMobil> v1(state, s1, { &e1 }, 20);
+
+	Routing r;
+	for (int i = 0; i < 2; ++i)
+	{
+		// repeated queries reuse the search buffers of the previous ones
+		r.compute(s1, { &e1 }, v1);
+		auto& segments = r.getSegments();
+		REQUIRE(segments.size() == 3);
+		REQUIRE(segments[0].connection == c1);
+		REQUIRE(segments[1].connection == c4);
+		REQUIRE(segments[2].connection == c5);
+	}
+}
+
+
+TEST_CASE("routing/routeTrees", "Test Routing following the cached shortest-path trees")
+{
+	/* Setup is as follows:
+	 * S1 --- M1 --- M2 --- M3 --- M4 --- E1
+	 *            \                    /
+	 *              ---- M5 ----------
+	 *                    \
+	 *                     -- E2
+	 *
+	 * where the path through M5 is longer
+	 */
+	Network n;
+	Node& s1 = *n.addNode({ 0, 0 });
+	Node& m1 = *n.addNode({ 1, 0 });
+	Node& m2 = *n.addNode({ 2, 0 });
+	Node& m3 = *n.addNode({ 3, 0 });
+	Node& m4 = *n.addNode({ 4, 0 });
+	Node& e1 = *n.addNode({ 5, 0 });
+	Node& m5 = *n.addNode({ 2.5, 1 });
+	Node& e2 = *n.addNode({ 3, 2 });
+
+	n.addConnection(s1, m1);
+	n.addConnection(m1, m2);
+	n.addConnection(m2, m3);
+	n.addConnection(m3, m4);
+	n.addConnection(m4, e1);
+	n.addConnection(m1, m5);
+	n.addConnection(m5, e1);
+	n.addConnection(m5, e2);
+
+	TrafficState state(n);
+	TypedVehicle<IdmMobil> v1(state, s1, { &e1 }, 10);
+
+	RouteTreeCache& cache = state.getRouteTrees();
+	REQUIRE(!cache.isEnabled());
+	cache.setRefreshInterval(10.0);
+	REQUIRE(cache.isEnabled());
+	cache.update(0.0);
+
+	// without any congestion, following the tree must yield the same routes as the search
+	Routing expected, r;
+	const std::vector< std::vector<Node*> > destinations{ { &e1 }, { &e2 }, { &e1, &e2 }, { &m3 }, { &s1 } };
+	for (auto& d : destinations)
+	{
+		for (auto& start : n.getNodes())
+		{
+			expected.compute(*start, d, v1);
+			r.follow(cache.getTree(d, v1.getTargetVelocity()), *start, v1);
+			REQUIRE(r.getSegments().size() == expected.getSegments().size());
+			for (size_t i = 0; i < r.getSegments().size(); ++i)
+			{
+				REQUIRE(r.getSegments()[i].connection == expected.getSegments()[i].connection);
+				REQUIRE(r.getSegments()[i].costs == expected.getSegments()[i].costs);
+			}
+		}
+	}
+	REQUIRE(cache.getNumTreeComputations() == destinations.size());
+
+	// trees are reused until the refresh interval has passed
+	cache.getTree({ &e1 }, v1.getTargetVelocity());
+	cache.update(5.0);
+	cache.getTree({ &e1 }, v1.getTargetVelocity());
+	REQUIRE(cache.getNumTreeComputations() == destinations.size());
+	cache.update(10.0);
+	cache.getTree({ &e1 }, v1.getTargetVelocity());
+	REQUIRE(cache.getNumTreeComputations() == destinations.size() + 1);
+
+	// adding a connection invalidates all trees
+	Node& m6 = *n.addNode({ 1.5, 0 });
+	n.addConnection(m6, e1);
+	state.resize();
+	cache.update(11.0);
+	REQUIRE(cache.getTree({ &e1 }, v1.getTargetVelocity()).costsToGo.size() == n.getNumNodes());
+	REQUIRE(cache.getNumTreeComputations() == destinations.size() + 2);
+}
+
+
+TEST_CASE("routing/landmarks", "Test Routing using landmarks as heuristic")
+{
+	// Grid of 10 x 10 nodes connected in both directions
+	Network n;
+	const int size = 10;
+	for (int y = 0; y < size; ++y)
+		for (int x = 0; x < size; ++x)
+			n.addNode({ x * 400.0, y * 400.0 });
+	for (int y = 0; y < size; ++y)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			Node& node = *n.getNodes()[y * size + x];
+			if (x + 1 < size)
+			{
+				n.addConnection(node, *n.getNodes()[y * size + x + 1]);
+				n.addConnection(*n.getNodes()[y * size + x + 1], node);
+			}
+			if (y + 1 < size)
+			{
+				n.addConnection(node, *n.getNodes()[(y + 1) * size + x]);
+				n.addConnection(*n.getNodes()[(y + 1) * size + x], node);
+			}
+		}
+	}
+	// the air-line distance only underestimates the costs on connections not faster than 14 m/s
+	for (Connection& c : n.getConnections())
+		c.setTargetVelocity(c.getIndex() % 4 == 0 ? 14 : 8);
+
+	TrafficState state(n);
+	Landmarks& landmarks = state.getLandmarks();
+	REQUIRE(landmarks.isEnabled());
+	REQUIRE(landmarks.getLandmarkNodes().size() == landmarks.getNumLandmarks());
+
+	const std::vector<Node*> destinations{ n.getNodes()[size * size / 2 + 3].get(), n.getNodes()[size - 1].get() };
+	TypedVehicle<IdmMobil> v1(state, *n.getNodes().front(), destinations, 20);
+
+	// the reverse shortest-path tree yields the exact costs toward the destination nodes
+	RouteTreeCache& cache = state.getRouteTrees();
+	cache.setRefreshInterval(1.0);
+
+	auto checkRoutes = [&](size_t& numExpandedNodes) {
+		const auto& tree = cache.getTree(destinations, v1.getTargetVelocity());
+		Routing r;
+		numExpandedNodes = 0;
+		for (auto& start : n.getNodes())
+		{
+			r.compute(*start, destinations, v1);
+			numExpandedNodes += r.getNumExpandedNodes();
+
+			double costs = 0.0;
+			for (auto& segment : r.getSegments())
+				costs += segment.costs;
+			REQUIRE(costs == Approx(tree.costsToGo[start->getIndex()]));
+		}
+	};
+
+	size_t landmarkExpandedNodes;
+	checkRoutes(landmarkExpandedNodes);
+
+	// the landmarks need to expand fewer nodes than the air-line distance
+	landmarks.setNumLandmarks(0);
+	state.resize();
+	REQUIRE(!landmarks.isEnabled());
+	size_t airLineExpandedNodes;
+	checkRoutes(airLineExpandedNodes);
+	REQUIRE(landmarkExpandedNodes < airLineExpandedNodes);
+
+	// faster connections make the landmarks outdated, they are recomputed when resizing the traffic state
+	landmarks.setNumLandmarks(4);
+	state.resize();
+	REQUIRE(!landmarks.update());
+	const size_t costRevision = n.getCostRevision();
+	for (Connection& c : n.getConnections())
+		c.setTargetVelocity(c.getIndex() % 3 == 0 ? 40 : 10);
+	REQUIRE(n.getCostRevision() > costRevision);
+	state.resize();
+	REQUIRE(!landmarks.update());
+	cache.invalidate();
+	checkRoutes(landmarkExpandedNodes);
+}
+
+
+TEST_CASE("routing/routeStore", "Test sharing routes and caching route queries in the RouteStore")
+{
+	// S --- M1 --- M2 --- E
+	Network n;
+	Node& s = *n.addNode({ 0, 0 });
+	Node& m1 = *n.addNode({ 10, 0 });
+	Node& m2 = *n.addNode({ 30, 0 });
+	Node& e = *n.addNode({ 60, 0 });
+	Connection* c1 = n.addConnection(s, m1);
+	Connection* c2 = n.addConnection(m1, m2);
+	n.addConnection(m2, e);
+
+	TrafficState state(n);
+	RouteStore& store = state.getRouteStore();
+	TypedVehicle<IdmMobil> v(state, s, { &e }, 10);
+
+	Routing r1;
+	Routing r2;
+	r1.compute(s, { &e }, v);
+	r2.compute(s, { &e }, v);
+	REQUIRE(r1.getRoute() != r2.getRoute());
+
+	// identical routes are shared after interning, the route of v was computed before v entered c1 and differs in its costs
+	r1.intern(store);
+	r2.intern(store);
+	REQUIRE(r1.getRoute() == r2.getRoute());
+	REQUIRE(r1.getRoute() != v.getRouting().getRoute());
+	REQUIRE(store.getNumRoutes() == 2);
+
+	// advancing does not modify the shared route
+	r1.advance();
+	REQUIRE(r1.getSegmentIndex() == 1);
+	REQUIRE(r1.getSegments().size() == 2);
+	REQUIRE(r1.getSegments().front().connection == c2);
+	REQUIRE(r2.getSegments().size() == 3);
+	REQUIRE(r2.getSegments().front().connection == c1);
+
+	// the route stays interned as long as it is used
+	Routing r4;
+	r4.compute(m1, { &e }, v);
+	r4.intern(store);
+	REQUIRE(store.getNumRoutes() == 3);
+	r4.setRoute(nullptr);
+	REQUIRE(store.getNumRoutes() == 2);
+
+	// query results are only cached while the route search uses the cost snapshot
+	Routing r3;
+	r3.compute(s, { &e }, v);
+	const RouteStore::Query query = RouteStore::makeQuery(s, { &e }, v.getTargetVelocity());
+	REQUIRE(!store.isQueryCacheEnabled());
+	store.insert(query, r3.getRoute());
+	REQUIRE(store.find(query) == nullptr);
+
+	state.setCostSnapshotInterval(5.0);
+	REQUIRE(store.isQueryCacheEnabled());
+	REQUIRE(store.find(query) == nullptr);
+	store.insert(query, r3.getRoute());
+	REQUIRE(store.find(query) == r3.getRoute());
+	REQUIRE(store.find(RouteStore::makeQuery(m1, { &e }, v.getTargetVelocity())) == nullptr);
+	REQUIRE(store.find(RouteStore::makeQuery(s, { &e }, v.getTargetVelocity() + 1.0)) == nullptr);
+	REQUIRE(store.getNumQueryHits() == 1);
+
+	// vehicles entering connections only change the costs of the next snapshot
+	TypedVehicle<IdmMobil> other(state, m1, { &e }, 10);
+	REQUIRE(store.find(query) == r3.getRoute());
+	const size_t revision = state.getCongestionRevision();
+	state.refreshCostSnapshot();
+	REQUIRE(state.getCongestionRevision() != revision);
+	REQUIRE(store.find(query) == nullptr);
+	REQUIRE(store.getNumQueryHits() == 2);
+}
@@ -0,0 +1,73 @@
+#include <catch.hpp>
+
+#include <cts-core/base/bounds.h>
+#include <cts-core/base/spatialgrid.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace cts;
+using namespace cts::core;
+
+
+TEST_CASE("SpatialGrid/random", "Check the query results against testing all boxes")
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> position(-1000.0, 1000.0);
+	std::uniform_real_distribution<double> extent(0.0, 100.0);
+
+	std::vector<Bounds2> bounds;
+	for (int i = 0; i < 1000; ++i)
+	{
+		const vec2 llf(position(rng), position(rng));
+		bounds.push_back(Bounds2{ llf, llf + vec2(extent(rng), extent(rng)) });
+	}
+	// a few degenerate boxes
+	bounds.push_back(Bounds2{ vec2(0.0, 0.0) });
+	bounds.push_back(Bounds2{ vec2(-1000.0, 0.0), vec2(1000.0, 0.0) });
+	bounds.push_back(Bounds2());
+
+	const SpatialGrid grid(bounds);
+	REQUIRE(grid.getNumCells().first > 1);
+	REQUIRE(grid.getNumCells().second > 1);
+
+	std::vector<size_t> result;
+	std::vector<size_t> expected;
+	for (int i = 0; i < 1000; ++i)
+	{
+		const vec2 llf(position(rng) * 1.2, position(rng) * 1.2);
+		const Bounds2 query{ llf, llf + vec2(extent(rng) * 2.0, extent(rng) * 2.0) };
+
+		expected.clear();
+		for (size_t j = 0; j < bounds.size(); ++j)
+		{
+			if (bounds[j].intersects(query))
+				expected.push_back(j);
+		}
+
+		grid.query(query, result);
+		REQUIRE(result == expected);
+	}
+
+	// every box finds at least itself
+	for (size_t j = 0; j + 1 < bounds.size(); ++j)
+	{
+		grid.query(bounds[j], result);
+		REQUIRE(std::find(result.begin(), result.end(), j) != result.end());
+	}
+
+	grid.query(Bounds2(), result);
+	REQUIRE(result.empty());
+}
+
+
+TEST_CASE("SpatialGrid/empty", "Check a grid without any boxes")
+{
+	const SpatialGrid grid({ Bounds2() });
+	REQUIRE(grid.getNumCells().first == 0);
+
+	std::vector<size_t> result{ 1, 2, 3 };
+	grid.query(Bounds2{ vec2(0.0, 0.0), vec2(1.0, 1.0) }, result);
+	REQUIRE(result.empty());
+}
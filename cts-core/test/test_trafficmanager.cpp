@@ -0,0 +1,337 @@
+#include <catch.hpp>
+
+#include <cts-core/network/connection.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+#include <cts-core/simulation/replicationrunner.h>
+#include <cts-core/simulation/simulation.h>
+#include <cts-core/traffic/trafficmanager.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehicle.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace cts;
+using namespace cts::core;
+
+
+namespace
+{
+	/* Setup is as follows:
+	 * S1 ---
+	 *        \
+	 *         M1 --- M2 --- E1
+	 *        /
+	 * S2 ---
+	 *
+	 * with heavy traffic from both start nodes so that vehicles have to follow each other.
+	 */
+	void setupMergeNetwork(Network& n)
+	{
+		Node* s1 = n.addNode({ 0, 0 });
+		Node* s2 = n.addNode({ 0, 400 });
+		Node* m1 = n.addNode({ 600, 200 });
+		Node* m2 = n.addNode({ 1200, 200 });
+		Node* e1 = n.addNode({ 2400, 200 });
+
+		n.addConnection(*s1, *m1);
+		n.addConnection(*s2, *m1);
+		n.addConnection(*m1, *m2)->setTargetVelocity(6);
+		n.addConnection(*m2, *e1);
+
+		n.addVolume({ s1 }, { e1 })->carsPerHour = 2000;
+		n.addVolume({ s2 }, { e1 })->carsPerHour = 2000;
+	}
+
+	std::vector<AbstractVehicle::State> simulate(size_t numThreads, int numTicks)
+	{
+		Network n;
+		setupMergeNetwork(n);
+
+		Simulation s(n);
+		s.getTrafficManager().setNumThreads(numThreads);
+		s.reset(42);
+		for (int i = 0; i < numTicks; ++i)
+			s.step();
+
+		std::vector<AbstractVehicle::State> toReturn;
+		for (auto& v : s.getTrafficManager().getVehicles())
+		{
+			toReturn.push_back(v->getFrozenState());
+		}
+		return toReturn;
+	}
+}
+
+
+TEST_CASE("TrafficManager/parallelThink", "Check that the concurrent think phase yields the same results as a single-threaded one")
+{
+	const auto reference = simulate(1, 2000);
+	REQUIRE(reference.size() > 10);
+
+	for (size_t numThreads : { 2, 3, 8 })
+	{
+		const auto result = simulate(numThreads, 2000);
+		REQUIRE(result.size() == reference.size());
+		for (size_t i = 0; i < result.size(); ++i)
+		{
+			// we explicitly want bit-identical results here
+			REQUIRE(result[i].arcPosition == reference[i].arcPosition);
+			REQUIRE(result[i].velocity == reference[i].velocity);
+			REQUIRE(result[i].acceleration == reference[i].acceleration);
+		}
+	}
+}
+
+
+TEST_CASE("TrafficManager/replications", "Check that concurrent replications yield the same results as sequential ones")
+{
+	Network n;
+	n.importLegacyXml(CTS_TEST_DATA_DIR "/intersection.xml");
+	REQUIRE(n.getIntersections().size() > 0);
+
+	ReplicationRunner runner(n);
+	runner.setDuration(300.0);
+	runner.setTrafficMultiplier(1.2);
+	runner.setNumThreads(1);
+	const std::vector<uint32_t> seeds{ 1, 2, 3, 4 };
+	const auto reference = runner.run(seeds);
+	REQUIRE(reference.results.size() == seeds.size());
+
+	// a replication must yield the same result as simulating the original network
+	{
+		Simulation s(n);
+		s.getTrafficManager().setGlobalTrafficMultiplier(runner.getTrafficMultiplier());
+		s.getTrafficManager().setNumThreads(1);
+		s.setTicksPerSecond(runner.getTicksPerSecond());
+		s.reset(seeds[0]);
+		while (s.getCurrentTime() < runner.getDuration())
+			s.step();
+
+		REQUIRE(reference.results[0].numTicks > 0);
+		REQUIRE(reference.results[0].statistics.numSpawnedVehicles > 0);
+		REQUIRE(reference.results[0].statistics.numSpawnedVehicles == s.getTrafficManager().getStatistics().numSpawnedVehicles);
+		REQUIRE(reference.results[0].statistics.numArrivedVehicles == s.getTrafficManager().getStatistics().numArrivedVehicles);
+		REQUIRE(reference.results[0].statistics.totalTravelTime == s.getTrafficManager().getStatistics().totalTravelTime);
+		REQUIRE(reference.results[0].numRemainingVehicles == s.getTrafficManager().getVehicles().size());
+	}
+
+	runner.setNumThreads(4);
+	const auto result = runner.run(seeds);
+	REQUIRE(result.results.size() == seeds.size());
+	for (size_t i = 0; i < seeds.size(); ++i)
+	{
+		REQUIRE(result.results[i].seed == seeds[i]);
+		REQUIRE(result.results[i].numTicks == reference.results[i].numTicks);
+		REQUIRE(result.results[i].statistics.numSpawnedVehicles == reference.results[i].statistics.numSpawnedVehicles);
+		REQUIRE(result.results[i].statistics.numArrivedVehicles == reference.results[i].statistics.numArrivedVehicles);
+		REQUIRE(result.results[i].statistics.totalTravelTime == reference.results[i].statistics.totalTravelTime);
+		REQUIRE(result.results[i].statistics.totalTravelDistance == reference.results[i].statistics.totalTravelDistance);
+		REQUIRE(result.results[i].numRemainingVehicles == reference.results[i].numRemainingVehicles);
+	}
+}
+
+
+TEST_CASE("TrafficManager/vehicleTypes", "Check spawning vehicles of additionally registered vehicle types")
+{
+	Network n;
+	Node* s1 = n.addNode({ 0, 0 });
+	Node* e1 = n.addNode({ 2400, 0 });
+	n.addConnection(*s1, *e1)->setTargetVelocity(30);
+	n.addVolume({ s1 }, { e1 })->trucksPerHour = 2000;
+
+	Simulation s(n);
+	TrafficManager& tm = s.getTrafficManager();
+	REQUIRE(tm.isVehicleTypeRegistered(VehicleType::Car));
+	REQUIRE(!tm.isVehicleTypeRegistered(VehicleType::Truck));
+
+	// trucks are not spawned by default
+	s.reset(42);
+	for (int i = 0; i < 300; ++i)
+		s.step();
+	REQUIRE(tm.getStatistics().numSpawnedVehicles == 0);
+
+	tm.clearVehicles();
+	REQUIRE(tm.registerVehicleType<IdmMobil>(VehicleType::Truck, 20));
+	REQUIRE(tm.isVehicleTypeRegistered(VehicleType::Truck));
+
+	s.reset(42);
+	for (int i = 0; i < 300; ++i)
+		s.step();
+	REQUIRE(tm.getStatistics().numSpawnedVehicles > 0);
+	REQUIRE(!tm.getVehicles().empty());
+	for (auto& v : tm.getVehicles())
+		REQUIRE(v->getTargetVelocity() == 20);
+
+	// the batches must not be replaced while they hold vehicles
+	REQUIRE(!tm.unregisterVehicleType(VehicleType::Truck));
+	REQUIRE(!tm.registerVehicleType<IdmMobil>(VehicleType::Truck, 10));
+	REQUIRE(tm.isVehicleTypeRegistered(VehicleType::Truck));
+	s.step();
+	for (auto& v : tm.getVehicles())
+		REQUIRE(v->getTargetVelocity() == 20);
+
+	tm.clearVehicles();
+	REQUIRE(tm.unregisterVehicleType(VehicleType::Truck));
+	REQUIRE(!tm.isVehicleTypeRegistered(VehicleType::Truck));
+}
+
+
+TEST_CASE("TrafficManager/vehicleOrder", "Check that the vehicles on each connection stay sorted by their arc position")
+{
+	Network n;
+	setupMergeNetwork(n);
+
+	Simulation s(n);
+	s.reset(42);
+	const TrafficState& trafficState = s.getTrafficState();
+	bool sorted = true;
+	bool found = true;
+	for (int i = 0; i < 2000; ++i)
+	{
+		s.step();
+		for (const Connection& c : n.getConnections())
+		{
+			const auto& vehicles = trafficState.getVehicles(c);
+			sorted &= std::is_sorted(vehicles.begin(), vehicles.end(), [](const AbstractVehicle* lhs, const AbstractVehicle* rhs) {
+				return lhs->getCurrentArcPosition() < rhs->getCurrentArcPosition();
+			});
+
+			// each vehicle must find its successor and predecessor on the same connection
+			for (size_t j = 0; j < vehicles.size(); ++j)
+			{
+				const double arcPosition = vehicles[j]->getCurrentArcPosition();
+				if (j + 1 < vehicles.size() && vehicles[j + 1]->getCurrentArcPosition() > arcPosition)
+					found &= (trafficState.getVehicleBehind(c, arcPosition, 0.0).vehicle == vehicles[j + 1]);
+				if (j > 0 && vehicles[j - 1]->getCurrentArcPosition() < arcPosition)
+					found &= (trafficState.getVehicleBefore(c, arcPosition, 0.0).vehicle == vehicles[j - 1]);
+			}
+		}
+	}
+	REQUIRE(sorted);
+	REQUIRE(found);
+	REQUIRE(s.getTrafficManager().getVehicles().size() > 10);
+}
+
+
+TEST_CASE("TrafficManager/routeRepair", "Check that vehicles keep their route as long as its costs do not change materially")
+{
+	Network n;
+	setupMergeNetwork(n);
+
+	// there is only a single route from each start node, hence repairing the routes must not change the results
+	std::vector<AbstractVehicle::State> results[2];
+	TrafficManager::Statistics statistics[2];
+	const double thresholds[2] = { -1.0, std::numeric_limits<double>::infinity() };
+	for (size_t i = 0; i < 2; ++i)
+	{
+		Simulation s(n);
+		s.getTrafficManager().setRouteRepairThreshold(thresholds[i]);
+		s.reset(42);
+		for (int j = 0; j < 2000; ++j)
+			s.step();
+
+		for (auto& v : s.getTrafficManager().getVehicles())
+		{
+			REQUIRE(v->getRouteRepairThreshold() == thresholds[i]);
+			results[i].push_back(v->getFrozenState());
+		}
+		statistics[i] = s.getTrafficManager().getStatistics();
+	}
+
+	// without repairing, each connection transition computes a new route
+	REQUIRE(statistics[0].numRouteRepairs == 0);
+	REQUIRE(statistics[0].numRouteComputations > statistics[0].numSpawnedVehicles);
+
+	// with an infinite threshold, only spawned vehicles compute their route
+	REQUIRE(statistics[1].numRouteComputations == statistics[1].numSpawnedVehicles);
+	REQUIRE(statistics[1].numRouteRepairs == statistics[0].numRouteComputations - statistics[0].numSpawnedVehicles);
+
+	REQUIRE(statistics[1].numArrivedVehicles == statistics[0].numArrivedVehicles);
+	REQUIRE(results[1].size() == results[0].size());
+	for (size_t i = 0; i < results[0].size(); ++i)
+	{
+		REQUIRE(results[1][i].arcPosition == results[0][i].arcPosition);
+		REQUIRE(results[1][i].velocity == results[0][i].velocity);
+	}
+}
+
+
+TEST_CASE("TrafficManager/routeTrees", "Check that vehicles can follow the cached shortest-path trees")
+{
+	Network n;
+	setupMergeNetwork(n);
+
+	// there is only a single route from each start node, hence the cached trees must not change the results
+	const auto reference = simulate(1, 2000);
+
+	Simulation s(n);
+	s.getTrafficManager().setRouteTreeInterval(5.0);
+	REQUIRE(s.getTrafficState().getRouteTrees().isEnabled());
+	s.reset(42);
+	for (int i = 0; i < 2000; ++i)
+		s.step();
+
+	const auto& vehicles = s.getTrafficManager().getVehicles();
+	REQUIRE(vehicles.size() == reference.size());
+	for (size_t i = 0; i < vehicles.size(); ++i)
+	{
+		REQUIRE(vehicles[i]->getFrozenState().arcPosition == reference[i].arcPosition);
+		REQUIRE(vehicles[i]->getFrozenState().velocity == reference[i].velocity);
+	}
+
+	// one tree per refresh interval at most, all vehicles share the same destination
+	const size_t numTrees = s.getTrafficState().getRouteTrees().getNumTreeComputations();
+	REQUIRE(numTrees > 0);
+	REQUIRE(numTrees <= size_t(s.getCurrentTime() / 5.0) + 1);
+	REQUIRE(numTrees < s.getTrafficManager().getStatistics().numRouteComputations);
+}
+
+
+TEST_CASE("TrafficManager/asyncRouting", "Check that planning routes asynchronously does not depend on the number of threads")
+{
+	Network n;
+	n.importLegacyXml(CTS_TEST_DATA_DIR "/intersection.xml");
+	REQUIRE(n.getIntersections().size() > 0);
+
+	std::vector<AbstractVehicle::State> results[2];
+	TrafficManager::Statistics statistics[2];
+	const size_t numThreads[2] = { 1, 4 };
+	for (size_t i = 0; i < 2; ++i)
+	{
+		Simulation s(n);
+		TrafficManager& tm = s.getTrafficManager();
+		tm.setNumThreads(numThreads[i]);
+		tm.setGlobalTrafficMultiplier(3.0);
+		tm.setRouteRepairThreshold(-1.0);
+		tm.setAsyncRouting(true);
+		s.reset(42);
+		for (int j = 0; j < 3000; ++j)
+			s.step();
+
+		for (auto& v : tm.getVehicles())
+		{
+			REQUIRE(v->getRoutePlanner() != nullptr);
+			results[i].push_back(v->getFrozenState());
+		}
+		statistics[i] = tm.getStatistics();
+	}
+
+	// routes requested while moving on to the next connection are delivered one tick later
+	REQUIRE(statistics[0].numRouteComputations > statistics[0].numSpawnedVehicles);
+	REQUIRE(statistics[0].numArrivedVehicles > 0);
+
+	// we explicitly want bit-identical results here
+	REQUIRE(statistics[1].numSpawnedVehicles == statistics[0].numSpawnedVehicles);
+	REQUIRE(statistics[1].numArrivedVehicles == statistics[0].numArrivedVehicles);
+	REQUIRE(statistics[1].numRouteComputations == statistics[0].numRouteComputations);
+	REQUIRE(statistics[1].totalTravelTime == statistics[0].totalTravelTime);
+	REQUIRE(results[1].size() == results[0].size());
+	for (size_t i = 0; i < results[0].size(); ++i)
+	{
+		REQUIRE(results[1][i].arcPosition == results[0][i].arcPosition);
+		REQUIRE(results[1][i].velocity == results[0][i].velocity);
+	}
+}
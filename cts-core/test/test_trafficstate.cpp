@@ -0,0 +1,346 @@
+#include <catch.hpp>
+
+#include <cts-core/network/connection.h>
+#include <cts-core/network/intersection.h>
+#include <cts-core/network/network.h>
+#include <cts-core/network/node.h>
+#include <cts-core/network/routing.h>
+#include <cts-core/traffic/trafficstate.h>
+#include <cts-core/traffic/vehicle.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace cts;
+using namespace cts::core;
+
+
+TEST_CASE("TrafficState/leaders", "Check that leaders are searched along the route of each vehicle")
+{
+	/* Setup is as follows:
+	 *               --- A
+	 *              /
+	 * S --- M1 ---
+	 *              \
+	 *               --- B
+	 */
+	Network n;
+	Node* s = n.addNode({ 0, 0 });
+	Node* m1 = n.addNode({ 400, 0 });
+	Node* a = n.addNode({ 800, -200 });
+	Node* b = n.addNode({ 800, 200 });
+	Connection* sm = n.addConnection(*s, *m1);
+	n.addConnection(*m1, *a);
+	Connection* mb = n.addConnection(*m1, *b);
+
+	TrafficState trafficState(n);
+	TypedVehicle<IdmMobil> toA(trafficState, *s, { a }, 20);
+	TypedVehicle<IdmMobil> toB(trafficState, *s, { b }, 20);
+	TypedVehicle<IdmMobil> behind(trafficState, *s, { b }, 20);
+	TypedVehicle<IdmMobil> onA(trafficState, *m1, { a }, 20);
+	TypedVehicle<IdmMobil> onB(trafficState, *m1, { b }, 20);
+	REQUIRE(toA.getCurrentConnection() == sm);
+	REQUIRE(onB.getCurrentConnection() == mb);
+
+	toA.setCurrentArcPosition(300);
+	toB.setCurrentArcPosition(300);
+	behind.setCurrentArcPosition(100);
+	onA.setCurrentArcPosition(150);
+	onB.setCurrentArcPosition(50);
+	trafficState.sortVehicles();
+	trafficState.updateLeaders(AbstractVehicle::getLookaheadDistance());
+
+	const auto& columns = trafficState.getVehicleStore().getColumns();
+	auto leaderOf = [&](const AbstractVehicle& v) {
+		const size_t index = trafficState.getVehicleStore().getIndex(v.getVehicleId());
+		return VehicleDistance(columns.leaders[index], columns.leaderDistances[index]);
+	};
+
+	// both vehicles at the same position follow their own routes
+	const double remainingArcLength = sm->getCurve().getArcLength() - 300;
+	REQUIRE(leaderOf(toA).vehicle == &onA);
+	REQUIRE(leaderOf(toA).distance == Approx(remainingArcLength + 150));
+	REQUIRE(leaderOf(toB).vehicle == &onB);
+	REQUIRE(leaderOf(toB).distance == Approx(remainingArcLength + 50));
+
+	// vehicles at the same position do not lead each other
+	const VehicleDistance vd = leaderOf(behind);
+	REQUIRE((vd.vehicle == &toA || vd.vehicle == &toB));
+	REQUIRE(vd.distance == 200);
+
+	REQUIRE(leaderOf(onA).empty());
+	REQUIRE(leaderOf(onB).empty());
+}
+
+
+TEST_CASE("TrafficState/leadersRegression", "Compare the leaders along the route with the recursive search over all following connections")
+{
+	Network n;
+	n.importLegacyXml(CTS_TEST_DATA_DIR "/intersection.xml");
+
+	std::vector<Node*> nodes;
+	for (auto& node : n.getNodes())
+		nodes.push_back(node.get());
+
+	TrafficState trafficState(n);
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<size_t> nodeIndex(0, nodes.size() - 1);
+	std::uniform_real_distribution<double> fraction(0.0, 1.0);
+	std::vector< std::unique_ptr< TypedVehicle<IdmMobil> > > vehicles;
+	for (int attempt = 0; attempt < 10000 && vehicles.size() < 150; ++attempt)
+	{
+		auto v = std::make_unique< TypedVehicle<IdmMobil> >(trafficState, *nodes[nodeIndex(rng)], std::vector<Node*>{ nodes[nodeIndex(rng)] }, 20);
+		if (v->getCurrentConnection() == nullptr)
+			continue;
+		v->setCurrentArcPosition(fraction(rng) * v->getCurrentConnection()->getCurve().getArcLength());
+		vehicles.push_back(std::move(v));
+	}
+	REQUIRE(vehicles.size() == 150);
+
+	const double lookaheadDistance = AbstractVehicle::getLookaheadDistance();
+	trafficState.sortVehicles();
+	trafficState.updateLeaders(lookaheadDistance);
+
+	// The recursive search returns the closest vehicle on any following connection. Hence, both searches
+	// must agree unless the recursive one found a closer vehicle on a connection off the route.
+	const auto& store = trafficState.getVehicleStore();
+	size_t numEqual = 0;
+	size_t numOffRoute = 0;
+	for (auto& v : vehicles)
+	{
+		const size_t index = store.getIndex(v->getVehicleId());
+		const VehicleDistance onRoute(store.getColumns().leaders[index], store.getColumns().leaderDistances[index]);
+		const VehicleDistance recursive = trafficState.getVehicleBehind(*v->getCurrentConnection(), v->getCurrentArcPosition(), lookaheadDistance);
+
+		if (onRoute.vehicle == recursive.vehicle)
+		{
+			if (!onRoute.empty())
+				REQUIRE(onRoute.distance == Approx(recursive.distance));
+			++numEqual;
+		}
+		else
+		{
+			REQUIRE(!recursive.empty());
+			REQUIRE((onRoute.empty() || recursive.distance < onRoute.distance));
+
+			const auto& segments = v->getRouting().getSegments();
+			const Connection* other = recursive.vehicle->getCurrentConnection();
+			REQUIRE(std::none_of(segments.begin(), segments.end(), [other](const Routing::Segment& s) { return s.connection == other; }));
+			++numOffRoute;
+		}
+	}
+
+	// make sure that both cases are covered
+	REQUIRE(numEqual > 0);
+	REQUIRE(numOffRoute > 0);
+}
+
+
+TEST_CASE("TrafficState/costSnapshot", "Check that the route search reads the connection costs from the snapshot")
+{
+	// S --- M --- E
+	Network n;
+	Node* s = n.addNode({ 0, 0 });
+	Node* m = n.addNode({ 400, 0 });
+	Node* e = n.addNode({ 800, 0 });
+	Connection* sm = n.addConnection(*s, *m);
+	Connection* me = n.addConnection(*m, *e);
+
+	TrafficState trafficState(n);
+	REQUIRE(!trafficState.isCostSnapshotEnabled());
+	const double freeArcLength = trafficState.getCongestedArcLength(*sm);
+	REQUIRE(freeArcLength == sm->getCurve().getArcLength());
+
+	// without snapshot, the costs follow the live traffic
+	size_t revision = trafficState.getCongestionRevision();
+	TypedVehicle<IdmMobil> first(trafficState, *s, { e }, 20);
+	REQUIRE(first.getCurrentConnection() == sm);
+	REQUIRE(trafficState.getCongestedArcLength(*sm) > freeArcLength);
+	REQUIRE(trafficState.getCongestionRevision() != revision);
+
+	// the snapshot keeps the costs until it is refreshed
+	trafficState.setCostSnapshotInterval(10.0);
+	REQUIRE(trafficState.isCostSnapshotEnabled());
+	const double congestedArcLength = trafficState.getCongestedArcLength(*sm);
+	REQUIRE(congestedArcLength == Routing::computeCongestedArcLength(*sm, 1));
+	REQUIRE(trafficState.getCongestedArcLength(*me) == me->getCurve().getArcLength());
+
+	revision = trafficState.getCongestionRevision();
+	TypedVehicle<IdmMobil> second(trafficState, *s, { e }, 20);
+	REQUIRE(trafficState.getVehicles(*sm).size() == 2);
+	REQUIRE(trafficState.getCongestedArcLength(*sm) == congestedArcLength);
+	REQUIRE(trafficState.getCongestionRevision() == revision);
+
+	trafficState.updateCostSnapshot(5.0);
+	REQUIRE(trafficState.getCongestedArcLength(*sm) == congestedArcLength);
+	REQUIRE(trafficState.getCongestionRevision() == revision);
+
+	trafficState.updateCostSnapshot(10.0);
+	REQUIRE(trafficState.getCongestedArcLength(*sm) == Routing::computeCongestedArcLength(*sm, 2));
+	REQUIRE(trafficState.getCongestionRevision() != revision);
+
+	// disabling the snapshot returns to the live traffic
+	trafficState.setCostSnapshotInterval(0.0);
+	REQUIRE(!trafficState.isCostSnapshotEnabled());
+	TypedVehicle<IdmMobil> third(trafficState, *s, { e }, 20);
+	REQUIRE(trafficState.getCongestedArcLength(*sm) == Routing::computeCongestedArcLength(*sm, 3));
+}
+
+
+TEST_CASE("TrafficState/removeConnection", "Check that the vehicles stay on their connections when the connection indices change")
+{
+	// X --- Y    S --- M --- E
+	Network n;
+	Node* x = n.addNode({ 0, 400 });
+	Node* y = n.addNode({ 400, 400 });
+	Node* s = n.addNode({ 0, 0 });
+	Node* m = n.addNode({ 400, 0 });
+	Node* e = n.addNode({ 800, 0 });
+	Connection* xy = n.addConnection(*x, *y);
+	Connection* sm = n.addConnection(*s, *m);
+	Connection* me = n.addConnection(*m, *e);
+
+	TrafficState trafficState(n);
+	TypedVehicle<IdmMobil> onSm(trafficState, *s, { e }, 20);
+	TypedVehicle<IdmMobil> onMe(trafficState, *m, { e }, 20);
+	REQUIRE(onSm.getCurrentConnection() == sm);
+	REQUIRE(onMe.getCurrentConnection() == me);
+
+	n.removeConnection(*xy);
+	REQUIRE(sm->getIndex() == 0);
+	REQUIRE(me->getIndex() == 1);
+	trafficState.resize();
+
+	REQUIRE(trafficState.getVehicles(*sm) == TrafficState::VehicleListType{ &onSm });
+	REQUIRE(trafficState.getVehicles(*me) == TrafficState::VehicleListType{ &onMe });
+
+	const auto& store = trafficState.getVehicleStore();
+	REQUIRE(store.getColumns().connectionIndices[store.getIndex(onSm.getVehicleId())] == sm->getIndex());
+	REQUIRE(store.getColumns().connectionIndices[store.getIndex(onMe.getVehicleId())] == me->getIndex());
+
+	// connections added afterwards start without vehicles
+	Connection* ys = n.addConnection(*y, *s);
+	trafficState.resize();
+	REQUIRE(trafficState.getVehicles(*ys).empty());
+	REQUIRE(trafficState.getVehicles(*me) == TrafficState::VehicleListType{ &onMe });
+}
+
+
+TEST_CASE("TrafficState/registrations", "Check registering vehicles with intersections by slot handles")
+{
+	Network n;
+	n.importLegacyXml(CTS_TEST_DATA_DIR "/intersection.xml");
+	REQUIRE(n.getIntersections().size() > 0);
+	const Intersection& intersection = *n.getIntersections()[0];
+	const Connection* a = &intersection.getFirstConnection();
+	const Connection* b = &intersection.getSecondConnection();
+
+	TrafficState trafficState(n);
+	// vehicles without any route, they are only registered manually here
+	TypedVehicle<IdmMobil> v1(trafficState, a->getStartNode(), {}, 20);
+	TypedVehicle<IdmMobil> v2(trafficState, a->getStartNode(), {}, 20);
+	TypedVehicle<IdmMobil> v3(trafficState, b->getStartNode(), {}, 20);
+
+	auto interferingVehicles = [&trafficState, &intersection](const Connection& connection, TrafficState::RegistrationHandle handle) {
+		trafficState.updateBlockingIndices();
+		std::vector<Intersection::CrossingVehicleInfo> toReturn;
+		trafficState.forEachInterferingVehicle(intersection, connection, handle, [&toReturn](const Intersection::CrossingVehicleInfo& cvt) {
+			toReturn.push_back(cvt);
+			return true;
+		});
+		return toReturn;
+	};
+
+	const auto h1 = trafficState.registerVehicle(intersection, v1, *a, 100, vec2(5, 10));
+	const auto h2 = trafficState.registerVehicle(intersection, v2, *a, 200, vec2(15, 20));
+	const auto h3 = trafficState.registerVehicle(intersection, v3, *b, 100, vec2(8, 12));
+	REQUIRE(h1 != h2);
+
+	// updates keep the original arrival time
+	trafficState.updateVehicle(intersection, *a, h1, 50, vec2(6, 9));
+	REQUIRE(trafficState.getCrossingVehicleInfo(intersection, *a, h1).originalArrivalTime == 5);
+	REQUIRE(trafficState.getCrossingVehicleInfo(intersection, *a, h1).remainingDistance == 50);
+	REQUIRE(trafficState.getCrossingVehicleInfo(intersection, *a, h2).remainingDistance == 200);
+
+	// waiting decisions only become visible after publishing them
+	trafficState.updateVehicleWait(intersection, *b, h3, true);
+	REQUIRE(!trafficState.getCrossingVehicleInfo(intersection, *b, h3).willWaitInFront);
+	REQUIRE(interferingVehicles(*a, h1).size() == 1);
+	trafficState.publishVehicleWait(intersection, *b, h3);
+	REQUIRE(trafficState.getCrossingVehicleInfo(intersection, *b, h3).willWaitInFront);
+	REQUIRE(interferingVehicles(*a, h1).empty());
+
+	// v1 and v2 block the intersection at different times
+	REQUIRE(interferingVehicles(*b, h3).size() == 1);
+	REQUIRE(interferingVehicles(*b, h3)[0].remainingDistance == 50);
+
+	// freed slots are reused while the other handles stay valid
+	trafficState.unregisterVehicle(intersection, *a, h1);
+	REQUIRE(interferingVehicles(*b, h3).empty());
+	const auto h4 = trafficState.registerVehicle(intersection, v1, *a, 80, vec2(7, 9));
+	REQUIRE(h4 == h1);
+	REQUIRE(trafficState.getCrossingVehicleInfo(intersection, *a, h2).remainingDistance == 200);
+	REQUIRE(trafficState.getCrossingVehicleInfo(intersection, *a, h4).originalArrivalTime == 7);
+	REQUIRE(trafficState.getIntersectionState(intersection).aCrossingVehicles.slots.size() == 2);
+}
+
+
+TEST_CASE("TrafficState/blockingIndex", "Check the blocking time index against testing all registrations")
+{
+	Network n;
+	n.importLegacyXml(CTS_TEST_DATA_DIR "/intersection.xml");
+	REQUIRE(n.getIntersections().size() > 0);
+	const Intersection& intersection = *n.getIntersections()[0];
+	const Connection& a = intersection.getFirstConnection();
+	const Connection& b = intersection.getSecondConnection();
+
+	// the registrations only refer to the vehicle, hence we can register the same one several times
+	TrafficState trafficState(n);
+	TypedVehicle<IdmMobil> v(trafficState, a.getStartNode(), {}, 20);
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> time(0.0, 100.0);
+	std::uniform_real_distribution<double> duration(0.0, 10.0);
+	auto randomInterval = [&]() {
+		const double begin = time(rng);
+		return vec2(begin, begin + duration(rng));
+	};
+
+	std::vector<TrafficState::RegistrationHandle> aHandles, bHandles;
+	for (int i = 0; i < 200; ++i)
+	{
+		aHandles.push_back(trafficState.registerVehicle(intersection, v, a, 100, randomInterval()));
+		bHandles.push_back(trafficState.registerVehicle(intersection, v, b, 100, randomInterval()));
+	}
+	for (size_t i = 0; i < bHandles.size(); i += 3)
+		trafficState.unregisterVehicle(intersection, b, bHandles[i]);
+	for (size_t i = 1; i < bHandles.size(); i += 3)
+		trafficState.updateVehicle(intersection, b, bHandles[i], 50, randomInterval());
+	trafficState.updateBlockingIndices();
+
+	bool allEqual = true;
+	for (auto h : aHandles)
+	{
+		const vec2 blockingTime = trafficState.getCrossingVehicleInfo(intersection, a, h).blockingTime;
+		size_t numExpected = 0;
+		for (size_t i = 0; i < bHandles.size(); ++i)
+		{
+			if (i % 3 == 0)
+				continue;
+			const vec2 other = trafficState.getCrossingVehicleInfo(intersection, b, bHandles[i]).blockingTime;
+			if (!(blockingTime[0] > other[1] || blockingTime[1] < other[0]))
+				++numExpected;
+		}
+
+		size_t numFound = 0;
+		trafficState.forEachInterferingVehicle(intersection, a, h, [&](const Intersection::CrossingVehicleInfo& cvt) {
+			allEqual &= !(blockingTime[0] > cvt.blockingTime[1] || blockingTime[1] < cvt.blockingTime[0]);
+			++numFound;
+			return true;
+		});
+		allEqual &= (numFound == numExpected);
+	}
+	REQUIRE(allEqual);
+}
@@ -0,0 +1,80 @@
+#include <catch.hpp>
+
+#include <cts-core/base/triplebuffer.h>
+
+#include <thread>
+
+using namespace cts;
+using namespace cts::core;
+
+
+TEST_CASE("TripleBuffer/basic", "Check publishing and fetching values")
+{
+	TripleBuffer<int> tb;
+	tb.getWriteBuffer() = 0;
+	REQUIRE(tb.fetch() == false);
+
+	tb.getWriteBuffer() = 1;
+	tb.publish();
+	REQUIRE(tb.fetch() == true);
+	REQUIRE(tb.getReadBuffer() == 1);
+	REQUIRE(tb.fetch() == false);
+	REQUIRE(tb.getReadBuffer() == 1);
+
+	// only the latest value should be fetched
+	tb.getWriteBuffer() = 2;
+	tb.publish();
+	tb.getWriteBuffer() = 3;
+	tb.publish();
+	REQUIRE(tb.fetch() == true);
+	REQUIRE(tb.getReadBuffer() == 3);
+
+	// the write buffer must never alias the read buffer
+	for (int i = 4; i < 10; ++i)
+	{
+		REQUIRE(&tb.getWriteBuffer() != &tb.getReadBuffer());
+		tb.getWriteBuffer() = i;
+		tb.publish();
+		REQUIRE(&tb.getWriteBuffer() != &tb.getReadBuffer());
+		REQUIRE(tb.getReadBuffer() == 3);
+	}
+	REQUIRE(tb.fetch() == true);
+	REQUIRE(tb.getReadBuffer() == 9);
+}
+
+
+TEST_CASE("TripleBuffer/threaded", "Check that concurrently fetched values are complete and monotonic")
+{
+	struct Value
+	{
+		int a;
+		int b;
+	};
+
+	const int numValues = 100000;
+	TripleBuffer<Value> tb;
+	tb.getWriteBuffer() = { 0, 0 };
+	tb.publish();
+
+	std::thread producer([&tb]() {
+		for (int i = 1; i <= numValues; ++i)
+		{
+			tb.getWriteBuffer() = { i, -i };
+			tb.publish();
+		}
+	});
+
+	int last = 0;
+	bool consistent = true;
+	while (last < numValues)
+	{
+		tb.fetch();
+		const Value& v = tb.getReadBuffer();
+		consistent &= (v.a == -v.b) && (v.a >= last);
+		last = v.a;
+	}
+	producer.join();
+
+	REQUIRE(consistent);
+	REQUIRE(last == numValues);
+}
@@ -0,0 +1,95 @@
+#include <catch.hpp>
+
+#include <cts-core/traffic/vehiclestore.h>
+
+using namespace cts;
+using namespace cts::core;
+
+
+TEST_CASE("VehicleStore/ids", "Check that vehicle ids stay stable while rows are removed")
+{
+	VehicleStore store;
+	AbstractVehicle* vehicles[4] = { reinterpret_cast<AbstractVehicle*>(0x10), reinterpret_cast<AbstractVehicle*>(0x20), reinterpret_cast<AbstractVehicle*>(0x30), reinterpret_cast<AbstractVehicle*>(0x40) };
+
+	VehicleId ids[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		ids[i] = store.add(vehicles[i], i, 10.0);
+		store.getColumns().arcPositions[store.getIndex(ids[i])] = 100.0 * i;
+	}
+	REQUIRE(store.size() == 4);
+
+	// removed rows are kept until the store is compacted
+	store.remove(ids[1]);
+	REQUIRE(store.size() == 4);
+	REQUIRE(store.getVehicle(1) == nullptr);
+	REQUIRE(store.getColumns().connectionIndices[1] == VehicleStore::noConnection);
+	REQUIRE(store.getVehicle(store.getIndex(ids[2])) == vehicles[2]);
+
+	// compacting keeps the order of all remaining rows
+	store.compact();
+	REQUIRE(store.size() == 3);
+	REQUIRE(store.getVehicle(0) == vehicles[0]);
+	REQUIRE(store.getVehicle(1) == vehicles[2]);
+	REQUIRE(store.getVehicle(2) == vehicles[3]);
+
+	for (int i : { 0, 2, 3 })
+	{
+		REQUIRE(store.getVehicle(store.getIndex(ids[i])) == vehicles[i]);
+		REQUIRE(store.getColumns().arcPositions[store.getIndex(ids[i])] == 100.0 * i);
+		REQUIRE(store.getColumns().velocities[store.getIndex(ids[i])] == double(i));
+	}
+
+	// new vehicles are appended
+	const VehicleId newId = store.add(vehicles[1], 0.0, 10.0);
+	REQUIRE(store.getIndex(newId) == 3);
+	REQUIRE(store.getVehicle(3) == vehicles[1]);
+	REQUIRE(store.getVehicle(store.getIndex(ids[3])) == vehicles[3]);
+
+	// several rows are erased by a single compaction
+	store.remove(ids[0]);
+	store.remove(ids[3]);
+	store.compact();
+	REQUIRE(store.size() == 2);
+	REQUIRE(store.getVehicle(0) == vehicles[2]);
+	REQUIRE(store.getVehicle(1) == vehicles[1]);
+	REQUIRE(store.getIndex(ids[2]) == 0);
+	REQUIRE(store.getIndex(newId) == 1);
+	REQUIRE(store.getColumns().arcPositions[0] == 200.0);
+}
+
+
+TEST_CASE("VehicleStore/move", "Check the freeze and move kernels")
+{
+	VehicleStore store;
+	for (int i = 0; i < 3; ++i)
+	{
+		const VehicleId id = store.add(nullptr, 10.0, 10.0);
+		auto& c = store.getColumns();
+		c.arcPositions[store.getIndex(id)] = 50.0 * i;
+		c.accelerations[store.getIndex(id)] = -1.0;
+		c.connectionLengths[store.getIndex(id)] = 150.0;
+		c.connectionIndices[store.getIndex(id)] = (i == 1) ? VehicleStore::noConnection : uint32_t(i);
+	}
+
+	store.freeze();
+	REQUIRE(store.getColumns().frozenStates[2].arcPosition == 100.0);
+	REQUIRE(store.getColumns().frozenStates[2].velocity == 10.0);
+	REQUIRE(store.getColumns().frozenStates[2].acceleration == -1.0);
+
+	std::vector<size_t> leavingVehicles;
+	store.move(1.0, leavingVehicles);
+
+	// arc positions are measured in dm
+	const auto& c = store.getColumns();
+	REQUIRE(c.velocities[0] == 9.0);
+	REQUIRE(c.arcPositions[0] == 90.0);
+	REQUIRE(c.travelledDistances[0] == 90.0);
+	REQUIRE(c.arcPositions[1] == 50.0);
+	REQUIRE(c.velocities[1] == 10.0);
+	REQUIRE(c.arcPositions[2] == 190.0);
+	REQUIRE(leavingVehicles == std::vector<size_t>{ 2 });
+
+	// the frozen state is not affected by moving
+	REQUIRE(c.frozenStates[2].arcPosition == 100.0);
+}
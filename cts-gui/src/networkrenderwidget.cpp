@@ -9,6 +9,7 @@
 #include <cts-core/network/node.h>
 #include <cts-core/network/routing.h>
 #include <cts-core/simulation/simulation.h>
+#include <cts-core/traffic/trafficstate.h>
 #include <cts-core/traffic/vehicle.h>
 
 #include <cmath>
@@ -80,7 +81,10 @@ namespace cts { namespace gui
 			m_simulation = value;
 
 			if (m_simulation != nullptr)
+			{
+				m_simulation->setRenderSnapshotsEnabled(true);
 				m_simulation->s_stepped.connect(this, &NetworkRenderWidget::onSimulationStep);
+			}
 		}
 	}
 
@@ -377,8 +381,6 @@ namespace cts { namespace gui
 		p.translate(m_zoomOffset.x(), m_zoomOffset.y());
 		p.scale(m_zoomFactor, m_zoomFactor);
 
-		std::lock_guard<std::mutex> lockGuard(m_simulation->getMutex());
-
 		// draw connections
 		QBrush connectionBrush(Qt::gray);
 		for (core::Connection& connection : m_network->getConnections())
@@ -462,77 +464,90 @@ namespace cts { namespace gui
 		}
 
 		// draw Intersections debug information
+		// This needs to access the live traffic state, hence we need to lock the simulation. However, we 
+		// never want to stall the simulation for debug output, so we simply skip it if the lock is taken.
 		if (m_drawDebugInfo)
 		{
-			p.setPen(Qt::darkMagenta);
-			p.setBrush(Qt::NoBrush);
-			for (auto& intersection : m_network->getIntersections())
+			std::unique_lock<std::mutex> debugLock(m_simulation->getMutex(), std::try_to_lock);
+			if (debugLock.owns_lock())
 			{
-				const core::BezierParameterization& ap = intersection->getFirstConnection().getCurve();
-				const core::BezierParameterization& bp = intersection->getSecondConnection().getCurve();
-				QPointF surroundingPoints[5]
+				p.setPen(Qt::darkMagenta);
+				p.setBrush(Qt::NoBrush);
+				for (auto& intersection : m_network->getIntersections())
 				{
-					toQt(ap.arcPositionToCoordinate(intersection->getFirstArcPosition() + intersection->getWaitingDistance())),
-					toQt(bp.arcPositionToCoordinate(intersection->getSecondArcPosition() + intersection->getWaitingDistance())),
-					toQt(ap.arcPositionToCoordinate(intersection->getFirstArcPosition() - intersection->getWaitingDistance())),
-					toQt(bp.arcPositionToCoordinate(intersection->getSecondArcPosition() - intersection->getWaitingDistance())),
-					toQt(ap.arcPositionToCoordinate(intersection->getFirstArcPosition() + intersection->getWaitingDistance()))
-				};
+					const core::BezierParameterization& ap = intersection->getFirstConnection().getCurve();
+					const core::BezierParameterization& bp = intersection->getSecondConnection().getCurve();
+					QPointF surroundingPoints[5]
+					{
+						toQt(ap.arcPositionToCoordinate(intersection->getFirstArcPosition() + intersection->getWaitingDistance())),
+						toQt(bp.arcPositionToCoordinate(intersection->getSecondArcPosition() + intersection->getWaitingDistance())),
+						toQt(ap.arcPositionToCoordinate(intersection->getFirstArcPosition() - intersection->getWaitingDistance())),
+						toQt(bp.arcPositionToCoordinate(intersection->getSecondArcPosition() - intersection->getWaitingDistance())),
+						toQt(ap.arcPositionToCoordinate(intersection->getFirstArcPosition() + intersection->getWaitingDistance()))
+					};
+
+					p.drawPolyline(surroundingPoints, 5);
+
+					const core::TrafficState::IntersectionState& is = m_simulation->getTrafficState().getIntersectionState(*intersection);
+					vec2 center = ap.arcPositionToCoordinate(intersection->getFirstArcPosition());
+					for (auto& it : is.aCrossingVehicles.slots)
+					{
+						if (it.vehicle == nullptr)
+							continue;
 
-				p.drawPolyline(surroundingPoints, 5);
+						vec2 vpos = it.vehicle->getCurrentConnection()->getCurve().arcPositionToCoordinate(it.vehicle->getCurrentArcPosition());
+						if (it.info.willWaitInFront)
+							p.setPen(Qt::darkRed);
+						else
+							p.setPen(Qt::darkGreen);
 
-				vec2 center = ap.arcPositionToCoordinate(intersection->getFirstArcPosition());
-				for (auto& it : intersection->m_aCrossingVehicles)
-				{
-					vec2 vpos = it.first->getCurrentConnection()->getCurve().arcPositionToCoordinate(it.first->getCurrentArcPosition());
-					if (it.second.willWaitInFront)
-						p.setPen(Qt::darkRed);
-					else
-						p.setPen(Qt::darkGreen);
-
-					p.drawLine(toQt(center), toQt(vpos));
-					p.drawText(toQt((center + vpos) / 2.0), tr("d:%1, t: [%2, %3]").arg(it.second.remainingDistance).arg(it.second.blockingTime[0]).arg(it.second.blockingTime[1]));
-				}
-				for (auto& it : intersection->m_bCrossingVehicles)
-				{
-					vec2 vpos = it.first->getCurrentConnection()->getCurve().arcPositionToCoordinate(it.first->getCurrentArcPosition());
-					if (it.second.willWaitInFront)
-						p.setPen(Qt::darkRed);
-					else
-						p.setPen(Qt::darkGreen);
-
-					p.drawLine(toQt(center), toQt(vpos));
-					p.drawText(toQt((center + vpos) / 2.0), tr("d:%1, t: [%2, %3]").arg(it.second.remainingDistance).arg(it.second.blockingTime[0]).arg(it.second.blockingTime[1]));
+						p.drawLine(toQt(center), toQt(vpos));
+						p.drawText(toQt((center + vpos) / 2.0), tr("d:%1, t: [%2, %3]").arg(it.info.remainingDistance).arg(it.info.blockingTime[0]).arg(it.info.blockingTime[1]));
+					}
+					for (auto& it : is.bCrossingVehicles.slots)
+					{
+						if (it.vehicle == nullptr)
+							continue;
+
+						vec2 vpos = it.vehicle->getCurrentConnection()->getCurve().arcPositionToCoordinate(it.vehicle->getCurrentArcPosition());
+						if (it.info.willWaitInFront)
+							p.setPen(Qt::darkRed);
+						else
+							p.setPen(Qt::darkGreen);
+
+						p.drawLine(toQt(center), toQt(vpos));
+						p.drawText(toQt((center + vpos) / 2.0), tr("d:%1, t: [%2, %3]").arg(it.info.remainingDistance).arg(it.info.blockingTime[0]).arg(it.info.blockingTime[1]));
+					}
 				}
 			}
 		}
 
 		// draw vehicles
+		// We only use the latest render snapshot here so that we never block the simulation thread.
+		const core::RenderSnapshot& snapshot = m_simulation->fetchRenderSnapshot();
 		p.setPen(Qt::NoPen);
-		p.setBrush(QBrush(QColor::fromRgbF(0.0, 0.75, 1.0, 1.0)));
-		for (auto& it : m_network->getTrafficManager().getVehicles())
+		for (auto& v : snapshot.vehicles)
 		{
-			if (it->getCurrentConnection() == nullptr)
-				continue;
-
-			const double time = it->getCurrentConnection()->getCurve().arcPositionToTime(it->getCurrentArcPosition());
-			const vec2 pos = it->getCurrentConnection()->getCurve().timeToCoordinate(time);
-			const vec2 orientation = it->getCurrentConnection()->getCurve().derivateAtTime(time).normalized();
-			const vec2 normal = math::rotatedClockwise(orientation);
-
+			const vec2 normal = math::rotatedClockwise(v.heading);
 			QPointF points[4]
 			{
-				toQt(pos - 8.0 * normal),
-				toQt(pos + 8.0 * normal),
-				toQt(pos - it->getLength() * orientation + 8.0 * normal),
-				toQt(pos - it->getLength() * orientation - 8.0 * normal)
+				toQt(v.position - 8.0 * normal),
+				toQt(v.position + 8.0 * normal),
+				toQt(v.position - v.length * v.heading + 8.0 * normal),
+				toQt(v.position - v.length * v.heading - 8.0 * normal)
 			};
+
+			if (v.state == core::VehicleSnapshot::DrivingState::Driving)
+				p.setBrush(QBrush(QColor::fromRgbF(0.0, 0.75, 1.0, 1.0)));
+			else
+				p.setBrush(QBrush(QColor::fromRgbF(1.0, 0.25, 0.0, 1.0)));
 			p.drawPolygon(points, 4);
 
 			if (m_drawDebugInfo)
 			{
 				p.setPen(Qt::black);
-				p.drawText(toQt(pos), tr("%1").arg(it->debugId));
+				p.drawText(toQt(v.position), tr("%1").arg(v.id));
+				p.setPen(Qt::NoPen);
 			}
 		}
 
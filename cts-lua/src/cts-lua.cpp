@@ -149,12 +149,16 @@ namespace cts
 			// functions
 			, "importLegacyXml", &core::Network::importLegacyXml
 			, "getConnections", &core::Network::getConnections
-			, "getTrafficManager", &core::Network::getTrafficManager
 		);
 
 
 		registerSignalType<>(luaState, "Signal<>");
 
+		ctsNamespace.new_enum("PacingMode"
+			, "RealTime", core::Simulation::PacingMode::RealTime
+			, "Unthrottled", core::Simulation::PacingMode::Unthrottled
+		);
+
 		ctsNamespace.new_usertype<core::Simulation>("Simulation"
 			// ctors
 			//, sol::constructors<core::Simulation(core::Network&)>()
@@ -165,6 +169,10 @@ namespace cts
 			, "setSpeed", &core::Simulation::setSpeed
 			, "getTicksPerSecond", &core::Simulation::getTicksPerSecond
 			, "setTicksPerSecond", &core::Simulation::setTicksPerSecond
+			, "pacingMode", sol::property(&core::Simulation::getPacingMode, &core::Simulation::setPacingMode)
+			, "maxCatchUpTicks", sol::property(&core::Simulation::getMaxCatchUpTicks, &core::Simulation::setMaxCatchUpTicks)
+			, "getRealTimeFactor", &core::Simulation::getRealTimeFactor
+			, "getTrafficManager", static_cast<core::TrafficManager& (core::Simulation::*)()>(&core::Simulation::getTrafficManager)
 			, "reset", &core::Simulation::reset
 			, "step", &core::Simulation::step
 			, "start", &core::Simulation::start